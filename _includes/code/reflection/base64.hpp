@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace jk {
+namespace base64 {
+
+// Standard alphabet with '=' padding, as in RFC 4648. The encoders and
+// decoders work 12 bytes to 16 characters at a time when SSSE3 is available,
+// using the pshufb lookups described by Wojciech Muła and Daniel Lemire.
+
+static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+constexpr std::size_t encoded_size(std::size_t n) {
+  return (n + 2) / 3 * 4;
+}
+
+// Length of the decoded data, or npos if src can't be base64
+constexpr std::size_t decoded_size(std::string_view src) {
+  if (src.size() % 4 != 0) {
+    return npos;
+  }
+  std::size_t padding = 0;
+  if (!src.empty() && src.back() == '=') {
+    padding = src[src.size() - 2] == '=' ? 2 : 1;
+  }
+  return src.size() / 4 * 3 - padding;
+}
+
+namespace detail {
+
+static constexpr char alphabet[] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static constexpr std::uint8_t invalid = 0xFF;
+
+constexpr std::array<std::uint8_t, 256> make_values() {
+  std::array<std::uint8_t, 256> values = {};
+  for (auto& v : values) {
+    v = invalid;
+  }
+  for (std::size_t i = 0; i < 64; ++i) {
+    values[static_cast<unsigned char>(alphabet[i])] = static_cast<std::uint8_t>(i);
+  }
+  return values;
+}
+
+static constexpr auto values = make_values();
+
+inline void encode_tail(const unsigned char* src, std::size_t n, char* dst) {
+  for (; n >= 3; n -= 3, src += 3, dst += 4) {
+    const std::uint32_t bits = (src[0] << 16) | (src[1] << 8) | src[2];
+    dst[0] = alphabet[bits >> 18];
+    dst[1] = alphabet[(bits >> 12) & 0x3F];
+    dst[2] = alphabet[(bits >> 6) & 0x3F];
+    dst[3] = alphabet[bits & 0x3F];
+  }
+  if (n > 0) {
+    const std::uint32_t bits = (src[0] << 16) | (n == 2 ? src[1] << 8 : 0);
+    dst[0] = alphabet[bits >> 18];
+    dst[1] = alphabet[(bits >> 12) & 0x3F];
+    dst[2] = n == 2 ? alphabet[(bits >> 6) & 0x3F] : '=';
+    dst[3] = '=';
+  }
+}
+
+// n is a multiple of 4 and only the last quartet may be padded
+inline bool decode_tail(const char* src, std::size_t n, unsigned char* dst) {
+  for (; n > 0; n -= 4, src += 4) {
+    const std::uint8_t a = values[static_cast<unsigned char>(src[0])];
+    const std::uint8_t b = values[static_cast<unsigned char>(src[1])];
+    if (a == invalid || b == invalid) {
+      return false;
+    }
+    *dst++ = static_cast<unsigned char>((a << 2) | (b >> 4));
+    if (n == 4 && src[3] == '=') {
+      if (src[2] == '=') {
+        return (b & 0x0F) == 0;
+      }
+      const std::uint8_t c = values[static_cast<unsigned char>(src[2])];
+      if (c == invalid || (c & 0x03) != 0) {
+        return false;
+      }
+      *dst++ = static_cast<unsigned char>((b << 4) | (c >> 2));
+      return true;
+    }
+    const std::uint8_t c = values[static_cast<unsigned char>(src[2])];
+    const std::uint8_t d = values[static_cast<unsigned char>(src[3])];
+    if (c == invalid || d == invalid) {
+      return false;
+    }
+    *dst++ = static_cast<unsigned char>((b << 4) | (c >> 2));
+    *dst++ = static_cast<unsigned char>((c << 6) | d);
+  }
+  return true;
+}
+
+}  // namespace detail
+
+// Writes encoded_size(n) characters to dst
+inline void encode(const void* data, std::size_t n, char* dst) {
+  const auto* src = static_cast<const unsigned char*>(data);
+#if defined(__SSSE3__)
+  // Each step loads 16 bytes and uses 12 of them
+  for (; n >= 16; n -= 12, src += 12, dst += 16) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    // Spread each 24 bits over four bytes of 6 bits
+    const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)),
+      _mm_set1_epi32(0x04000040));
+    const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)),
+      _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t0, t1);
+
+    // Offset from index to character for each of the five alphabet ranges
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    range = _mm_or_si128(range,
+      _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+      _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range)));
+  }
+#endif
+  detail::encode_tail(src, n, dst);
+}
+
+// Writes decoded_size(src) bytes to dst. Returns false if src has a
+// character outside the alphabet or isn't a valid length.
+inline bool decode(std::string_view src, void* data) {
+  if (decoded_size(src) == npos) {
+    return false;
+  }
+  auto* dst = static_cast<unsigned char*>(data);
+  const char* in = src.data();
+  std::size_t n = src.size();
+#if defined(__SSSE3__)
+  // Each step stores 16 bytes of which 12 are kept, so the last quartets are
+  // left to the scalar loop
+  for (; n >= 24; n -= 16, in += 16, dst += 12) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(v, 4), _mm_set1_epi8(0x0F));
+    const __m128i lo_nibbles = _mm_and_si128(v, _mm_set1_epi8(0x0F));
+
+    // A character is valid if its low and high nibble classes don't overlap
+    const __m128i lo_classes = _mm_shuffle_epi8(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A), lo_nibbles);
+    const __m128i hi_classes = _mm_shuffle_epi8(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04,
+      0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10), hi_nibbles);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo_classes, hi_classes),
+          _mm_setzero_si128())) != 0) {
+      return false;
+    }
+
+    // Character to 6-bit value, with '/' telling itself apart from '+'
+    const __m128i rolls = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i is_slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+    const __m128i sextets = _mm_add_epi8(v,
+      _mm_shuffle_epi8(rolls, _mm_add_epi8(is_slash, hi_nibbles)));
+
+    // Pack four sextets into three bytes per 32-bit lane, then the lanes together
+    const __m128i pairs = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+    const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(words,
+      _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+  }
+#endif
+  return detail::decode_tail(in, n, dst);
+}
+
+}  // namespace base64
+}  // namespace jk
@@ -0,0 +1,138 @@
+// Drives reflser::serialize_chunks through a pipe the way a server drives a
+// socket: one thread polls both ends, writes a chunk whenever the pipe has
+// room and drains whatever has arrived. The pipe holds far less than the
+// whole document, so the encoder is suspended whenever the pipe is full.
+// Checks that the bytes read back equal serialize's output for every chunk
+// size.
+//
+//   c++ -std=c++2a -O2 -I../reflexpr chunks.cpp -o chunks
+//   chunks [n_points]
+//
+// The reflection forks of clang take -fcoroutines-ts instead of -std=c++2a.
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "reflchunks.hpp"
+
+struct point {
+  std::int32_t x;
+  double y;
+};
+
+struct snapshot {
+  std::string name;
+  std::vector<point> points;
+  std::vector<std::int32_t> ids;
+};
+
+snapshot make_snapshot(std::size_t n) {
+  snapshot value{"snapshot", {}, {}};
+  value.points.reserve(n);
+  value.ids.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    value.points.push_back(point{static_cast<std::int32_t>(i), i * 0.25});
+    value.ids.push_back(static_cast<std::int32_t>(i * 7));
+  }
+  return value;
+}
+
+// Everything read from the pipe, or an empty string if a system call failed
+std::string pump(const snapshot& value, std::size_t chunk_size, std::size_t& n_chunks) {
+  int fds[2];
+  if (::pipe(fds) != 0) {
+    return {};
+  }
+  const int read_fd = fds[0];
+  int write_fd = fds[1];
+  ::fcntl(read_fd, F_SETFL, O_NONBLOCK);
+  ::fcntl(write_fd, F_SETFL, O_NONBLOCK);
+
+  auto chunks = reflser::serialize_chunks(value, chunk_size);
+  std::string_view pending;
+  std::string received;
+  char buffer[1 << 16];
+  bool failed = false;
+  n_chunks = 0;
+
+  while (!failed) {
+    pollfd polled[2] = {{read_fd, POLLIN, 0}, {write_fd, POLLOUT, 0}};
+    if (::poll(polled, write_fd >= 0 ? 2 : 1, -1) < 0) {
+      failed = errno != EINTR;
+      continue;
+    }
+
+    if (write_fd >= 0 && (polled[1].revents & POLLOUT)) {
+      if (pending.empty()) {
+        pending = chunks.next();
+        n_chunks += !pending.empty();
+      }
+      if (pending.empty()) {
+        // Done; closing the write end lets the reader see end of file
+        ::close(write_fd);
+        write_fd = -1;
+      } else if (const ssize_t written = ::write(write_fd, pending.data(), pending.size());
+                 written > 0) {
+        pending.remove_prefix(static_cast<std::size_t>(written));
+      } else if (written < 0 && errno != EAGAIN && errno != EINTR) {
+        failed = true;
+      }
+    }
+
+    if (polled[0].revents & (POLLIN | POLLHUP)) {
+      const ssize_t n = ::read(read_fd, buffer, sizeof(buffer));
+      if (n > 0) {
+        received.append(buffer, static_cast<std::size_t>(n));
+      } else if (n == 0) {
+        break;
+      } else if (errno != EAGAIN && errno != EINTR) {
+        failed = true;
+      }
+    }
+  }
+
+  if (write_fd >= 0) {
+    ::close(write_fd);
+  }
+  ::close(read_fd);
+  if (failed || chunks.result() != reflser::serialize_result::success) {
+    return {};
+  }
+  return received;
+}
+
+int main(int argc, char** argv) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  const auto value = make_snapshot(n);
+
+  std::string whole;
+  if (reflser::serialize(value, whole) != reflser::serialize_result::success) {
+    std::fprintf(stderr, "serialize failed\n");
+    return 1;
+  }
+
+  bool ok = true;
+  for (std::size_t chunk_size : {std::size_t(512), std::size_t(16384), std::size_t(262144)}) {
+    std::size_t n_chunks = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const std::string received = pump(value, chunk_size, n_chunks);
+    const auto end = std::chrono::steady_clock::now();
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    const bool matches = received == whole;
+    ok &= matches;
+    std::printf("chunk %7zu %10zu bytes %8zu chunks %10.2f ms %8.1f MB/s%s\n", chunk_size,
+      received.size(), n_chunks, ms, received.size() / 1e3 / ms, matches ? "" : "  MISMATCH");
+  }
+  return ok ? 0 : 1;
+}
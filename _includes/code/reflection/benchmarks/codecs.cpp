@@ -0,0 +1,271 @@
+// Throughput of reflser::serialize and deserialize, the cost of
+// reflcompare::equal and the latency of reflopt::parse over synthetic
+// corpora: flat scalar records, deeply nested records, string-heavy records,
+// numeric-array-heavy records, byte-buffer records and a wide record with
+// 200 members. Build
+// against either backend and name it in the output:
+//
+//   c++ -std=c++1z -O2 -I../reflexpr -DREFLBENCH_BACKEND=reflexpr codecs.cpp -o codecs
+//   codecs [n_records]
+//
+// Every result is one line, so the output of two revisions or two backends
+// can be diffed or compared with codecs.sh:
+//
+//   backend corpus operation value unit
+
+#define BOOST_HANA_CONFIG_ENABLE_STRING_UDL
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <boost/preprocessor/repetition/repeat.hpp>
+
+#include "comparisons.hpp"
+#include "reflopt.hpp"
+#include "reflser.hpp"
+
+#ifndef REFLBENCH_BACKEND
+#define REFLBENCH_BACKEND unknown
+#endif
+
+#define REFLBENCH_STRING_HELPER(x) #x
+#define REFLBENCH_STRING(x) REFLBENCH_STRING_HELPER(x)
+
+using namespace boost::hana::literals;
+
+namespace refl = jk::refl_utilities;
+
+struct flat {
+  std::uint64_t id;
+  std::int32_t count;
+  double price;
+  bool active;
+  std::int16_t level;
+  float ratio;
+  std::uint32_t flags;
+};
+
+struct leaf {
+  std::int32_t value;
+  double weight;
+};
+
+struct nested1 { leaf inner; std::int32_t tag; };
+struct nested2 { nested1 inner; std::int32_t tag; };
+struct nested3 { nested2 inner; std::int32_t tag; };
+struct nested4 { nested3 inner; std::int32_t tag; };
+struct nested5 { nested4 inner; std::int32_t tag; };
+struct nested6 { nested5 inner; std::int32_t tag; };
+
+struct strings {
+  std::string name;
+  std::string email;
+  std::string street;
+  std::string city;
+  std::string country;
+  std::string notes;
+};
+
+struct arrays {
+  std::vector<double> samples;
+  std::vector<std::int32_t> counts;
+  std::vector<float> weights;
+};
+
+struct blobs {
+  std::uint64_t id;
+  std::vector<std::uint8_t> image;
+  std::vector<std::uint8_t> thumbnail;
+};
+
+#define REFLBENCH_FIELD_HELPER(i, j) std::int32_t f ## i ## _ ## j;
+#define REFLBENCH_FIELD(z, j, i) REFLBENCH_FIELD_HELPER(i, j)
+#define REFLBENCH_FIELD_GROUP(z, i, data) BOOST_PP_REPEAT_ ## z(50, REFLBENCH_FIELD, i)
+
+struct wide {
+  BOOST_PP_REPEAT(4, REFLBENCH_FIELD_GROUP, ~)
+};
+
+struct bench_options {
+  REFLOPT_OPTION(int, threads, "--threads");
+  REFLOPT_OPTION(int, port, "--port");
+  REFLOPT_OPTION(int, retries, "--retries");
+  REFLOPT_OPTION(int, backlog, "--backlog");
+  REFLOPT_OPTION(double, timeout, "--timeout");
+  REFLOPT_OPTION(double, ratio, "--ratio");
+  REFLOPT_OPTION(std::string, host, "--host");
+  REFLOPT_OPTION(std::string, log_path, "--log-path");
+  REFLOPT_OPTION(std::string, region, "--region");
+  REFLOPT_OPTION(std::string, user, "--user");
+};
+
+// Random contents for any reflected record, so each corpus is only a struct
+template<typename T, typename Rng>
+void fill(T& value, Rng& rng) {
+  if constexpr (std::is_same<T, bool>{}) {
+    value = rng() % 2;
+  } else if constexpr (std::is_integral<T>{}) {
+    value = static_cast<T>(rng());
+  } else if constexpr (std::is_floating_point<T>{}) {
+    value = std::uniform_real_distribution<T>(-1e6, 1e6)(rng);
+  } else if constexpr (std::is_same<T, std::string>{}) {
+    value.resize(8 + rng() % 56);
+    for (auto& c : value) {
+      c = static_cast<char>('a' + rng() % 26);
+    }
+  } else if constexpr (refl::is_record<T>{}) {
+    refl::for_each_member<T>([&value, &rng](const auto& member) {
+      fill(value.*member.pointer, rng);
+    });
+  } else {
+    value.resize(16 + rng() % 112);
+    for (auto& entry : value) {
+      fill(entry, rng);
+    }
+  }
+}
+
+// Floating point members are written with std::to_string, which rounds, so
+// only records without them can be expected to decode to the original
+template<typename T>
+constexpr bool has_floating_point() {
+  if constexpr (std::is_floating_point<T>{}) {
+    return true;
+  } else if constexpr (refl::is_record<T>{}) {
+    bool result = false;
+    refl::for_each_member<T>([&result](const auto& member) {
+      result = result || has_floating_point<typename std::decay_t<decltype(member)>::type>();
+    });
+    return result;
+  } else if constexpr (std::is_same<T, std::string>{} || !std::is_class<T>{}) {
+    return false;
+  } else {
+    return has_floating_point<typename T::value_type>();
+  }
+}
+
+template<typename F>
+double time_ms(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Fastest of a few runs, so one preempted run doesn't show up as a regression
+template<typename F>
+double best_ms(F&& f) {
+  double best = time_ms(f);
+  for (int i = 0; i < 4; ++i) {
+    best = std::min(best, time_ms(f));
+  }
+  return best;
+}
+
+void report(const char* corpus, const char* operation, double value, const char* unit) {
+  std::printf("%s %s %s %.3f %s\n", REFLBENCH_STRING(REFLBENCH_BACKEND), corpus, operation,
+    value, unit);
+}
+
+template<typename T>
+bool run_corpus(const char* corpus, std::size_t n) {
+  std::mt19937_64 rng(42);
+  std::vector<T> records(n);
+  for (auto& record : records) {
+    fill(record, rng);
+  }
+
+  std::vector<std::string> encoded(n);
+  const double serialize_ms = best_ms([&] {
+    for (std::size_t i = 0; i < n; ++i) {
+      encoded[i].clear();
+      reflser::serialize(records[i], encoded[i]);
+    }
+  });
+  std::size_t bytes = 0;
+  for (const auto& text : encoded) {
+    bytes += text.size();
+  }
+
+  std::vector<T> decoded(n);
+  bool decode_ok = true;
+  const double deserialize_ms = best_ms([&] {
+    for (std::size_t i = 0; i < n; ++i) {
+      std::string_view src = encoded[i];
+      decode_ok &= reflser::deserialize(src, decoded[i]) == reflser::deserialize_result::success;
+    }
+  });
+  bool round_trip_ok = decode_ok;
+  if constexpr (!has_floating_point<T>()) {
+    for (std::size_t i = 0; i < n && round_trip_ok; ++i) {
+      round_trip_ok = reflcompare::equal(decoded[i], records[i]);
+    }
+  }
+
+  // Equal pairs, so every member is visited. Floating point members don't
+  // survive the text round trip exactly, so the pairs are copies.
+  const std::vector<T> copies = records;
+  std::size_t n_equal = 0;
+  const double equal_ms = best_ms([&] {
+    n_equal = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      n_equal += reflcompare::equal(records[i], copies[i]);
+    }
+  });
+  const bool equal_ok = n_equal == n;
+
+  const double mb = bytes / 1e6;
+  report(corpus, "serialize", mb / (serialize_ms / 1e3), "MB/s");
+  report(corpus, "deserialize", mb / (deserialize_ms / 1e3), "MB/s");
+  report(corpus, "equal", equal_ms * 1e6 / n, "ns/op");
+  if (!decode_ok) {
+    std::fprintf(stderr, "%s: a record failed to deserialize\n", corpus);
+  } else if (!round_trip_ok) {
+    std::fprintf(stderr, "%s: a record didn't round trip\n", corpus);
+  }
+  if (!equal_ok) {
+    std::fprintf(stderr, "%s: a record didn't compare equal to its copy\n", corpus);
+  }
+  return round_trip_ok && equal_ok;
+}
+
+bool run_options(std::size_t n) {
+  const char* argv[] = {
+    "codecs", "--threads", "8", "--port", "8080", "--retries", "3", "--backlog", "128",
+    "--timeout", "2.5", "--ratio", "0.75", "--host", "localhost",
+    "--log-path", "/var/log/bench.log", "--region", "us-east-1", "--user", "bench"
+  };
+  const int argc = sizeof(argv) / sizeof(argv[0]);
+
+  std::size_t n_parsed = 0;
+  const double parse_ms = best_ms([&] {
+    n_parsed = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      n_parsed += static_cast<bool>(reflopt::parse<bench_options>(argc, argv));
+    }
+  });
+  report("options", "parse", parse_ms * 1e6 / n, "ns/op");
+  return n_parsed == n;
+}
+
+int main(int argc, char** argv) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+
+  bool ok = true;
+  ok &= run_corpus<flat>("flat", n);
+  ok &= run_corpus<nested6>("nested", n);
+  ok &= run_corpus<strings>("strings", n);
+  ok &= run_corpus<arrays>("arrays", n / 10 + 1);
+  ok &= run_corpus<blobs>("blobs", n / 10 + 1);
+  ok &= run_corpus<wide>("wide", n / 10 + 1);
+  ok &= run_options(n);
+  return ok ? 0 : 1;
+}
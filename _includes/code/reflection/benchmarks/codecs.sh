@@ -0,0 +1,84 @@
+#!/bin/sh
+# Runtime benchmark harness for the reflection codecs. Builds codecs.cpp with
+# each backend that has a compiler configured and prints its result lines:
+#
+#   backend corpus operation value unit
+#
+#   REFLEXPR_CXX=/path/to/reflexpr/clang++ CPP3K_CXX=/path/to/cpp3k/clang++ \
+#     ./codecs.sh run 10000 > new.txt
+#
+# Extra compiler flags, such as -mssse3 for the SIMD base64 codec, can be
+# passed in CXXFLAGS.
+#
+# Two saved outputs, e.g. from two revisions, can be compared line by line.
+# Each row shows both values and the change, with "!" marking changes worse
+# than the threshold percentage (higher MB/s and lower ns/op are better):
+#
+#   ./codecs.sh compare old.txt new.txt [threshold]
+#
+# Rows are matched by backend, corpus and operation. If the two outputs were
+# built with different backends, e.g. one run with only REFLEXPR_CXX set and
+# one with only CPP3K_CXX, rows are matched by corpus and operation so the
+# backends are compared with each other.
+
+set -eu
+
+cd "$(dirname "$0")"
+
+command=${1:-run}
+shift || true
+
+if [ "$command" = compare ]; then
+  if [ $# -lt 2 ]; then
+    echo "usage: codecs.sh compare old.txt new.txt [threshold]" >&2
+    exit 1
+  fi
+  backends() {
+    awk '{ print $1 }' "$1" | sort -u
+  }
+  same_backends=0
+  if [ "$(backends "$1")" = "$(backends "$2")" ]; then
+    same_backends=1
+  fi
+  awk -v threshold="${3:-5}" -v same_backends="$same_backends" '
+    function key() { return (same_backends ? $1 " " : "") $2 " " $3 }
+    NR == FNR { old[key()] = $4; old_backend[key()] = $1; next }
+    key() in old {
+      before = old[key()]
+      backend = old_backend[key()] == $1 ? $1 : old_backend[key()] "/" $1
+      change = before == 0 ? 0 : 100 * ($4 - before) / before
+      worse = $5 == "MB/s" ? -change : change
+      printf "%-14s %-8s %-12s %12.3f %12.3f %+8.1f%% %s%s\n", backend, $2, $3, before, $4,
+        change, $5, (worse > threshold ? "  !" : "")
+    }' "$1" "$2"
+  exit 0
+fi
+
+if [ "$command" != run ]; then
+  echo "unknown command: $command" >&2
+  exit 1
+fi
+
+records=${1:-10000}
+
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+
+run() {
+  backend=$1
+  cxx=$2
+  "$cxx" -std=c++1z -O2 -DNDEBUG ${CXXFLAGS:-} -I"../$backend" -DREFLBENCH_BACKEND="$backend" \
+    codecs.cpp -o "$workdir/codecs_$backend"
+  "$workdir/codecs_$backend" "$records"
+}
+
+if [ -n "${REFLEXPR_CXX:-}" ]; then
+  run reflexpr "$REFLEXPR_CXX"
+fi
+if [ -n "${CPP3K_CXX:-}" ]; then
+  run cpp3k "$CPP3K_CXX"
+fi
+if [ -z "${REFLEXPR_CXX:-}${CPP3K_CXX:-}" ]; then
+  echo "set REFLEXPR_CXX and/or CPP3K_CXX to the backend compilers" >&2
+  exit 1
+fi
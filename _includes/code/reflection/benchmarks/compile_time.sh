@@ -0,0 +1,65 @@
+#!/bin/sh
+# Compile-time benchmark harness for the reflection headers. For each backend
+# that has a compiler configured and each struct size, compiles one of the
+# *_compile_time.cpp benchmarks and prints one line:
+#
+#   backend benchmark members seconds peak_kb instantiations
+#
+# instantiations is the number of template instantiation events in clang's
+# -ftime-trace output, or "-" when the compiler doesn't support it.
+#
+#   REFLEXPR_CXX=/path/to/reflexpr/clang++ CPP3K_CXX=/path/to/cpp3k/clang++ \
+#     ./compile_time.sh member_lookup 50 200 1000
+#
+# The benchmark name is member_lookup or options; sizes must be multiples of 50.
+
+set -eu
+
+cd "$(dirname "$0")"
+
+benchmark=${1:-member_lookup}
+shift || true
+sizes=${*:-50 200 1000}
+
+case "$benchmark" in
+  member_lookup) define=REFLBENCH_GROUPS ;;
+  options) define=REFLOPT_BENCH_GROUPS ;;
+  *) echo "unknown benchmark: $benchmark" >&2; exit 1 ;;
+esac
+
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+
+run() {
+  backend=$1
+  cxx=$2
+  for n in $sizes; do
+    if [ $((n % 50)) -ne 0 ]; then
+      echo "size $n is not a multiple of 50" >&2
+      exit 1
+    fi
+    trace_flags=""
+    if "$cxx" -ftime-trace -x c++ -fsyntax-only /dev/null >/dev/null 2>&1; then
+      trace_flags="-ftime-trace"
+    fi
+    /usr/bin/time -f "%e %M" -o "$workdir/time" \
+      "$cxx" -std=c++1z -I"../$backend" -D"$define=$((n / 50))" $trace_flags \
+        -c "${benchmark}_compile_time.cpp" -o "$workdir/bench.o"
+    instantiations=-
+    if [ -n "$trace_flags" ] && [ -f "$workdir/bench.json" ]; then
+      instantiations=$(grep -o '"name":"Instantiate[A-Za-z]*"' "$workdir/bench.json" | wc -l)
+    fi
+    echo "$backend $benchmark $n $(cat "$workdir/time") $instantiations"
+  done
+}
+
+if [ -n "${REFLEXPR_CXX:-}" ]; then
+  run reflexpr "$REFLEXPR_CXX"
+fi
+if [ -n "${CPP3K_CXX:-}" ]; then
+  run cpp3k "$CPP3K_CXX"
+fi
+if [ -z "${REFLEXPR_CXX:-}${CPP3K_CXX:-}" ]; then
+  echo "set REFLEXPR_CXX and/or CPP3K_CXX to the backend compilers" >&2
+  exit 1
+fi
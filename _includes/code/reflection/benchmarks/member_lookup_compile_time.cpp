@@ -0,0 +1,45 @@
+// Compile-time cost of looking up every member of a struct with
+// 50 * REFLBENCH_GROUPS int members by name through refl_utilities. Run it
+// through compile_time.sh to get compile time, peak memory and template
+// instantiation counts for growing struct sizes on either backend.
+
+#include <cstddef>
+
+#include <boost/preprocessor/repetition/repeat.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+#include "refl_utilities.hpp"
+
+#ifndef REFLBENCH_GROUPS
+#define REFLBENCH_GROUPS 4
+#endif
+
+namespace refl = jk::refl_utilities;
+
+#define REFLBENCH_MEMBER_HELPER(i, j) int m ## i ## _ ## j;
+#define REFLBENCH_MEMBER(z, j, i) REFLBENCH_MEMBER_HELPER(i, j)
+#define REFLBENCH_MEMBERS(z, i, data) BOOST_PP_REPEAT_ ## z(50, REFLBENCH_MEMBER, i)
+
+struct bench_record {
+  BOOST_PP_REPEAT(REFLBENCH_GROUPS, REFLBENCH_MEMBERS, ~)
+};
+
+// One named lookup per member, as reflser's deserialization does
+#if __has_include(<reflexpr>)
+#define REFLBENCH_LOOKUP_HELPER(i, j) \
+  static constexpr char name ## i ## _ ## j[] = BOOST_PP_STRINGIZE(m ## i ## _ ## j); \
+  static_assert(refl::get_member_pointer<bench_record, name ## i ## _ ## j>() \
+      == &bench_record::m ## i ## _ ## j);
+#else
+#define REFLBENCH_LOOKUP_HELPER(i, j) \
+  static_assert(refl::index_of_member<bench_record>(BOOST_PP_STRINGIZE(m ## i ## _ ## j)) \
+      == (i) * 50 + (j));
+#endif
+#define REFLBENCH_LOOKUP(z, j, i) REFLBENCH_LOOKUP_HELPER(i, j)
+#define REFLBENCH_LOOKUPS(z, i, data) BOOST_PP_REPEAT_ ## z(50, REFLBENCH_LOOKUP, i)
+
+BOOST_PP_REPEAT(REFLBENCH_GROUPS, REFLBENCH_LOOKUPS, ~)
+
+int main() {
+  return 0;
+}
@@ -0,0 +1,49 @@
+// Compile-time cost of reflopt::OptionsMap for a struct with
+// 50 * REFLOPT_BENCH_GROUPS generated int options. The number to track is the
+// compiler's own time and peak memory, e.g. from the benchmarks directory:
+//
+//   for n in 50 200 1000; do
+//     /usr/bin/time -f "$n options: %es %MKB" $CXX -std=c++1z -I../reflexpr \
+//       -DREFLOPT_BENCH_GROUPS=$((n / 50)) -c options_compile_time.cpp -o /dev/null
+//   done
+//
+// Use -I../cpp3k for the cpp3k backend, and add -DREFLOPT_BENCH_PREFIX_MAP to
+// measure the hana map implementation (reflopt::PrefixMap) for comparison.
+// compile_time.sh options runs the same loop for both backends.
+
+#define BOOST_HANA_CONFIG_ENABLE_STRING_UDL
+
+#include <boost/preprocessor/repetition/repeat.hpp>
+
+#include "reflopt.hpp"
+
+#ifndef REFLOPT_BENCH_GROUPS
+#define REFLOPT_BENCH_GROUPS 4
+#endif
+
+using namespace boost::hana::literals;
+
+#define REFLOPT_BENCH_STRING(x) #x
+#define REFLOPT_BENCH_OPTION_HELPER(i, j) \
+  REFLOPT_OPTION(int, o ## i ## _ ## j, REFLOPT_BENCH_STRING(--o ## i ## _ ## j));
+#define REFLOPT_BENCH_OPTION(z, j, i) REFLOPT_BENCH_OPTION_HELPER(i, j)
+#define REFLOPT_BENCH_GROUP(z, i, data) BOOST_PP_REPEAT_ ## z(50, REFLOPT_BENCH_OPTION, i)
+
+struct bench_options {
+  BOOST_PP_REPEAT(REFLOPT_BENCH_GROUPS, REFLOPT_BENCH_GROUP, ~)
+};
+
+int main(int argc, char** argv) {
+#ifdef REFLOPT_BENCH_PREFIX_MAP
+  bench_options options;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!reflopt::PrefixMap<bench_options>::contains(argv[i])) {
+      return 1;
+    }
+    reflopt::PrefixMap<bench_options>::set(options, argv[i], argv[i + 1]);
+  }
+  return 0;
+#else
+  return reflopt::parse<bench_options>(argc, argv) ? 0 : 1;
+#endif
+}
@@ -0,0 +1,87 @@
+// Compares reflsort::radix_sort against std::sort and std::stable_sort with the
+// equivalent reflcompare::less_by comparator.
+//
+//   radix_sort [n_records]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../radix_sort.hpp"
+
+struct record {
+  std::uint64_t id;
+  std::int32_t score;
+  double weight;
+  std::string region;
+};
+
+std::vector<record> make_records(std::size_t n) {
+  static const char* regions[] = {
+    "us-east-1", "us-west-2", "eu-west-1", "eu-central-1", "ap-south-1",
+    "ap-northeast-1", "sa-east-1", "ca-central-1"
+  };
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<std::int32_t> score(-100000, 100000);
+  std::normal_distribution<double> weight(0.0, 1000.0);
+  std::vector<record> records(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    records[i] = record{rng(), score(rng), weight(rng),
+      std::string(regions[rng() % 8]) + "/" + std::to_string(rng() % 1000)};
+  }
+  return records;
+}
+
+template<typename F>
+double time_ms(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template<auto ...Members>
+bool run_case(const char* name, const std::vector<record>& input) {
+  using less = reflcompare::less_by<Members...>;
+
+  auto by_sort = input;
+  auto by_stable_sort = input;
+  auto by_radix = input;
+  const double sort_ms = time_ms([&] { std::sort(by_sort.begin(), by_sort.end(), less{}); });
+  const double stable_ms = time_ms([&] {
+    std::stable_sort(by_stable_sort.begin(), by_stable_sort.end(), less{});
+  });
+  const double radix_ms = time_ms([&] { reflsort::radix_sort<Members...>(by_radix); });
+
+  // radix_sort is stable, so it has to match std::stable_sort exactly
+  bool matches = true;
+  for (std::size_t i = 0; i < input.size() && matches; ++i) {
+    matches = by_radix[i].id == by_stable_sort[i].id;
+  }
+
+  const double per_record = 1e6 / input.size();
+  std::printf("%-14s %-16s %10.2f ms %8.1f ns/record\n", name, "std::sort",
+    sort_ms, sort_ms * per_record);
+  std::printf("%-14s %-16s %10.2f ms %8.1f ns/record\n", name, "std::stable_sort",
+    stable_ms, stable_ms * per_record);
+  std::printf("%-14s %-16s %10.2f ms %8.1f ns/record%s\n", name, "radix_sort",
+    radix_ms, radix_ms * per_record, matches ? "" : "  MISMATCH");
+  return matches;
+}
+
+int main(int argc, char** argv) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const auto records = make_records(n);
+
+  bool ok = true;
+  ok &= run_case<&record::id>("id", records);
+  ok &= run_case<&record::score, &record::id>("score,id", records);
+  ok &= run_case<&record::weight>("weight", records);
+  ok &= run_case<&record::region, &record::score>("region,score", records);
+  return ok ? 0 : 1;
+}
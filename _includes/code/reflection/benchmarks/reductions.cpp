@@ -0,0 +1,167 @@
+// Compares reflreduce reductions over one member against hand-written loops,
+// reading the member with a stride from a std::vector of records and
+// directly from a soa_vector column, single-threaded and on all cores.
+// Build against either backend:
+//
+//   c++ -std=c++1z -O2 -pthread -I../reflexpr reductions.cpp -o reductions
+//   reductions [n_records]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "reflreduce.hpp"
+
+namespace refl = jk::refl_utilities;
+
+struct record {
+  std::uint64_t id;
+  std::int32_t latency;
+  double weight;
+  std::string region;
+};
+
+static constexpr char latency_name[] = "latency";
+
+std::vector<record> make_records(std::size_t n) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<std::int32_t> latency(0, 100000);
+  std::normal_distribution<double> weight(0.0, 1000.0);
+  std::vector<record> records(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    records[i] = record{rng(), latency(rng), weight(rng), "us-east-1"};
+  }
+  return records;
+}
+
+template<typename F>
+double time_ms(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template<typename R>
+bool matches(const R& a, const R& b) {
+  return a == b;
+}
+
+bool matches(double a, double b) {
+  return std::abs(a - b) <= 1e-9 * std::max(std::abs(a), std::abs(b));
+}
+
+bool matches(const reflreduce::bin_counts& a, const reflreduce::bin_counts& b) {
+  return a.counts == b.counts && a.underflow == b.underflow && a.overflow == b.overflow;
+}
+
+// Times the hand loop and each reflreduce variant, checking every result
+// against the hand loop's
+template<typename Hand, typename Reduce>
+bool run_case(const char* name, std::size_t n, Hand&& hand, Reduce&& reduce) {
+  const reflreduce::reduce_options serial{1 << 16, 1};
+  const reflreduce::reduce_options parallel{};
+
+  decltype(hand()) expected;
+  const double hand_ms = time_ms([&] { expected = hand(); });
+  const double per_record = 1e6 / n;
+  std::printf("%-16s %-20s %10.2f ms %8.3f ns/record\n", name, "hand loop",
+    hand_ms, hand_ms * per_record);
+
+  bool ok = true;
+  struct variant {
+    const char* name;
+    bool soa;
+    const reflreduce::reduce_options& options;
+  };
+  for (const auto& v : {variant{"vector, 1 thread", false, serial},
+      variant{"vector, all threads", false, parallel},
+      variant{"soa, 1 thread", true, serial},
+      variant{"soa, all threads", true, parallel}}) {
+    decltype(hand()) result;
+    const double ms = time_ms([&] { result = reduce(v.soa, v.options); });
+    const bool match = matches(result, expected);
+    ok &= match;
+    std::printf("%-16s %-20s %10.2f ms %8.3f ns/record%s\n", name, v.name,
+      ms, ms * per_record, match ? "" : "  MISMATCH");
+  }
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+  const auto records = make_records(n);
+  refl::soa_vector<record> columns;
+  columns.append(records.begin(), records.end());
+
+  bool ok = true;
+
+  ok &= run_case("sum latency", n,
+    [&] {
+      std::int64_t result = 0;
+      for (const auto& r : records) {
+        result += r.latency;
+      }
+      return result;
+    },
+    [&](bool soa, const reflreduce::reduce_options& options) {
+      return soa ? reflreduce::sum<latency_name>(columns, options)
+        : reflreduce::sum<latency_name>(records, options);
+    });
+
+  ok &= run_case("sum weight", n,
+    [&] {
+      double result = 0;
+      for (const auto& r : records) {
+        result += r.weight;
+      }
+      return result;
+    },
+    [&](bool soa, const reflreduce::reduce_options& options) {
+      return soa ? reflreduce::sum<&record::weight>(columns, options)
+        : reflreduce::sum<&record::weight>(records, options);
+    });
+
+  ok &= run_case("minmax weight", n,
+    [&] {
+      double lo = records[0].weight;
+      double hi = records[0].weight;
+      for (const auto& r : records) {
+        lo = std::min(lo, r.weight);
+        hi = std::max(hi, r.weight);
+      }
+      return std::make_pair(lo, hi);
+    },
+    [&](bool soa, const reflreduce::reduce_options& options) {
+      return *(soa ? reflreduce::minmax<&record::weight>(columns, options)
+        : reflreduce::minmax<&record::weight>(records, options));
+    });
+
+  ok &= run_case("histogram latency", n,
+    [&] {
+      reflreduce::bin_counts result{0, 90000, std::vector<std::size_t>(64)};
+      const double scale = 64 / 90000.0;
+      for (const auto& r : records) {
+        if (r.latency < result.lower) {
+          ++result.underflow;
+        } else if (!(r.latency < result.upper)) {
+          ++result.overflow;
+        } else {
+          ++result.counts[static_cast<std::size_t>((r.latency - result.lower) * scale)];
+        }
+      }
+      return result;
+    },
+    [&](bool soa, const reflreduce::reduce_options& options) {
+      return soa ? reflreduce::histogram<&record::latency>(columns, 0, 90000, 64, options)
+        : reflreduce::histogram<&record::latency>(records, 0, 90000, 64, options);
+    });
+
+  return ok ? 0 : 1;
+}
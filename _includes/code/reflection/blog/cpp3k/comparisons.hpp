@@ -0,0 +1,30 @@
+// cpp3k/comparisons.hpp as quoted by _posts/2017-05-06-reflection2.md, kept unchanged for the post
+
+#pragma once
+
+#include "meta_utilities.hpp"
+#include "refl_utilities.hpp"
+
+
+namespace reflcompare {
+
+namespace refl = jk::refl_utilities;
+namespace metap = jk::metaprogramming;
+namespace meta = cpp3k::meta;
+
+template<typename T>
+bool equal(const T& a, const T& b) {
+  if constexpr (metap::is_detected<metap::equality_comparable, T>{}) {
+    return a == b;
+  } else {
+    bool result = true;
+    meta::for_each($T.member_variables(),
+      [&a, &b, &result](auto&& member){
+        result &= equal(a.*member.pointer(), b.*member.pointer());
+      }
+    );
+    return result;
+  }
+}
+
+}  // namespace reflcompare
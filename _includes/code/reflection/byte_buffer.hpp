@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace jk {
+namespace refl_utilities {
+
+template<typename T>
+using byte_buffer_element_t =
+  std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<T&>().data())>>;
+
+// Contiguous runs of raw bytes, such as std::vector<std::uint8_t> or
+// std::array<std::byte, N>. reflser writes them as one base64 string rather
+// than an array with a number per byte.
+template<typename T, typename = void>
+struct is_byte_buffer : std::false_type {};
+
+template<typename T>
+struct is_byte_buffer<T, std::void_t<byte_buffer_element_t<T>,
+    decltype(std::declval<const T&>().size())>>
+  : std::integral_constant<bool, std::is_same<byte_buffer_element_t<T>, unsigned char>{} ||
+      std::is_same<byte_buffer_element_t<T>, std::byte>{}> {};
+
+}  // namespace refl_utilities
+}  // namespace jk
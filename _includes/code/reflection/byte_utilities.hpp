@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace jk {
+namespace byte_utilities {
+
+// Compare n bytes, 64 at a time when SSE2 is available. Empty ranges may
+// have null pointers, as std::vector::data() does, so memcmp isn't called.
+inline bool equal(const void* a, const void* b, std::size_t n) {
+#if defined(__SSE2__)
+  const auto* pa = static_cast<const unsigned char*>(a);
+  const auto* pb = static_cast<const unsigned char*>(b);
+  auto load = [](const unsigned char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  };
+
+  std::size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    const __m128i eq0 = _mm_cmpeq_epi8(load(pa + i), load(pb + i));
+    const __m128i eq1 = _mm_cmpeq_epi8(load(pa + i + 16), load(pb + i + 16));
+    const __m128i eq2 = _mm_cmpeq_epi8(load(pa + i + 32), load(pb + i + 32));
+    const __m128i eq3 = _mm_cmpeq_epi8(load(pa + i + 48), load(pb + i + 48));
+    const __m128i all = _mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3));
+    if (_mm_movemask_epi8(all) != 0xFFFF) {
+      return false;
+    }
+  }
+  for (; i + 16 <= n; i += 16) {
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(load(pa + i), load(pb + i))) != 0xFFFF) {
+      return false;
+    }
+  }
+  return i == n || std::memcmp(pa + i, pb + i, n - i) == 0;
+#else
+  return n == 0 || std::memcmp(a, b, n) == 0;
+#endif
+}
+
+namespace detail {
+
+static constexpr std::uint64_t prime1 = 11400714785074694791ull;
+static constexpr std::uint64_t prime2 = 14029467366897019727ull;
+static constexpr std::uint64_t prime3 = 1609587929392839161ull;
+static constexpr std::uint64_t prime4 = 9650029242287828579ull;
+static constexpr std::uint64_t prime5 = 2870177450012600261ull;
+
+constexpr std::uint64_t rotl(std::uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t load64(const unsigned char* p) {
+  std::uint64_t result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+inline std::uint32_t load32(const unsigned char* p) {
+  std::uint32_t result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+constexpr std::uint64_t lane_round(std::uint64_t acc, std::uint64_t input) {
+  return rotl(acc + input * prime2, 31) * prime1;
+}
+
+constexpr std::uint64_t merge_round(std::uint64_t acc, std::uint64_t lane) {
+  return (acc ^ lane_round(0, lane)) * prime1 + prime4;
+}
+
+}  // namespace detail
+
+// xxHash64. Inputs of 32 bytes or more are consumed by four independent
+// lanes, so the main loop keeps four multiplies in flight per iteration.
+inline std::uint64_t hash(const void* data, std::size_t n, std::uint64_t seed = 0) {
+  using namespace detail;
+  const auto* p = static_cast<const unsigned char*>(data);
+  const auto* const end = p + n;
+  std::uint64_t h;
+
+  if (n >= 32) {
+    std::uint64_t v1 = seed + prime1 + prime2;
+    std::uint64_t v2 = seed + prime2;
+    std::uint64_t v3 = seed;
+    std::uint64_t v4 = seed - prime1;
+    for (; p + 32 <= end; p += 32) {
+      v1 = lane_round(v1, load64(p));
+      v2 = lane_round(v2, load64(p + 8));
+      v3 = lane_round(v3, load64(p + 16));
+      v4 = lane_round(v4, load64(p + 24));
+    }
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = merge_round(h, v1);
+    h = merge_round(h, v2);
+    h = merge_round(h, v3);
+    h = merge_round(h, v4);
+  } else {
+    h = seed + prime5;
+  }
+
+  h += n;
+  for (; p + 8 <= end; p += 8) {
+    h = rotl(h ^ lane_round(0, load64(p)), 27) * prime1 + prime4;
+  }
+  if (p + 4 <= end) {
+    h = rotl(h ^ (std::uint64_t(load32(p)) * prime1), 23) * prime2 + prime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h = rotl(h ^ (*p * prime5), 11) * prime1;
+  }
+
+  h ^= h >> 33;
+  h *= prime2;
+  h ^= h >> 29;
+  h *= prime3;
+  h ^= h >> 32;
+  return h;
+}
+
+constexpr std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t value) {
+  return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+}  // namespace byte_utilities
+}  // namespace jk
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+
+namespace reflcompare {
+
+namespace metap = jk::metaprogramming;
+
+// Member-wise equality of reflected records. Defined by the backend's
+// comparisons.hpp.
+template<typename T>
+bool equal(const T& a, const T& b);
+
+template<typename T>
+using contiguous_range = decltype(
+  std::declval<const T&>().data() + std::declval<const T&>().size());
+
+template<typename T>
+using contiguous_element_t = std::remove_cv_t<
+  std::remove_pointer_t<decltype(std::declval<const T&>().data())>>;
+
+template<typename T>
+constexpr bool is_bytewise_comparable();
+
+template<typename T, std::size_t ...I>
+constexpr bool members_bytewise_comparable(std::index_sequence<I...>) {
+  using namespace jk::refl_utilities;
+  return (is_bytewise_comparable<typename member_info_t<T, I>::type>() && ...) &&
+    (sizeof(typename member_info_t<T, I>::type) + ... + 0) == sizeof(T);
+}
+
+// The value of T is exactly its bytes (no padding, no floating point), and
+// neither T nor anything inside it defines an equality operator that could
+// mean something else. Records qualify if their reflected members qualify
+// and cover all of T; classes that can't be looked into don't.
+template<typename T>
+constexpr bool is_bytewise_comparable() {
+  if constexpr (!std::has_unique_object_representations<T>{}) {
+    return false;
+  } else if constexpr (std::is_scalar<T>{}) {
+    return true;
+  } else if constexpr (std::is_array<T>{}) {
+    return is_bytewise_comparable<std::remove_all_extents_t<T>>();
+  } else if constexpr (metap::is_detected<metap::equality_comparable, T>{} ||
+                       !jk::refl_utilities::is_record<T>{}) {
+    return false;
+  } else {
+    return members_bytewise_comparable<T>(
+      std::make_index_sequence<jk::refl_utilities::n_members<T>>{});
+  }
+}
+
+template<typename T>
+constexpr bool is_bytewise_comparable_range() {
+  if constexpr (metap::is_detected<contiguous_range, T>{}) {
+    return is_bytewise_comparable<contiguous_element_t<T>>();
+  } else {
+    return false;
+  }
+}
+
+}  // namespace reflcompare
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "byte_buffer.hpp"
+#include "hot_cold.hpp"
+#include "intern_pool.hpp"
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+#include "soa_vector.hpp"
+
+// Coroutines come from C++20 or, on older compilers such as the reflection
+// forks of clang, the Coroutines TS (-fcoroutines-ts)
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+namespace reflser::chunk_detail {
+namespace co = std;
+}
+#elif defined(__cpp_coroutines) && __has_include(<experimental/coroutine>)
+#include <experimental/coroutine>
+namespace reflser::chunk_detail {
+namespace co = std::experimental;
+}
+#else
+#error "chunked_serializer.hpp needs coroutine support (-std=c++20 or -fcoroutines-ts)"
+#endif
+
+// The same JSON as reflser::serialize, produced a chunk at a time so that one
+// thread can interleave many large encodes and only encode as fast as the
+// output drains:
+//
+// auto chunks = reflser::serialize_chunks(value, 64 * 1024);
+// // whenever the socket is writable
+// if (std::string_view chunk = chunks.next(); !chunk.empty()) {
+//   write(fd, chunk.data(), chunk.size());
+// } else {
+//   // done, or stopped early if chunks.result() isn't success
+// }
+//
+// Records and arrays are walked by coroutines that suspend once a chunk is
+// full, so a stream holds at most a chunk plus the largest scalar or string
+// it writes. Everything else goes through serialize, which must be declared
+// before this header is included. The value must outlive the stream.
+namespace reflser {
+
+namespace chunk_detail {
+
+namespace metap = jk::metaprogramming;
+namespace refl = jk::refl_utilities;
+
+struct chunk_state {
+  std::size_t chunk_size;
+  std::string buffer;
+  serialize_result result = serialize_result::success;
+
+  bool full() const {
+    return buffer.size() >= chunk_size;
+  }
+};
+
+struct flush {};
+
+// A coroutine that writes to a chunk_state. A parent co_awaits its children
+// and every one of them may co_yield flush{} to hand a full buffer to the
+// reader. The reader resumes whichever coroutine is innermost, so nesting
+// depth never grows the native stack.
+class encoder {
+public:
+  struct promise_type {
+    promise_type* root = this;
+    promise_type* parent = nullptr;
+    // Only kept up to date on the root
+    promise_type* leaf = this;
+    bool yielded = false;
+    std::exception_ptr exception;
+
+    encoder get_return_object() {
+      return encoder(handle_type::from_promise(*this));
+    }
+
+    co::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    co::suspend_always final_suspend() noexcept {
+      return {};
+    }
+
+    co::suspend_always yield_value(flush) noexcept {
+      root->yielded = true;
+      return {};
+    }
+
+    void return_void() {}
+
+    void unhandled_exception() {
+      root->exception = std::current_exception();
+    }
+  };
+
+  using handle_type = co::coroutine_handle<promise_type>;
+
+  // Nothing left to do, for values written without a coroutine
+  encoder() = default;
+
+  explicit encoder(handle_type handle) : handle_(handle) {}
+
+  encoder(encoder&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  encoder& operator=(encoder&& other) noexcept {
+    if (this != &other) {
+      reset();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  ~encoder() {
+    reset();
+  }
+
+  // Makes the child the innermost coroutine; the reader resumes it next
+  bool await_ready() const noexcept {
+    return !handle_;
+  }
+
+  void await_suspend(handle_type parent) noexcept {
+    promise_type& child = handle_.promise();
+    child.parent = &parent.promise();
+    child.root = parent.promise().root;
+    child.root->leaf = &child;
+  }
+
+  void await_resume() const noexcept {}
+
+  // Runs until a chunk is ready or the whole value has been written.
+  // Returns false once there is nothing left to run.
+  bool step() {
+    if (!handle_) {
+      return false;
+    }
+    promise_type& root = handle_.promise();
+    while (!handle_.done()) {
+      auto current = handle_type::from_promise(*root.leaf);
+      current.resume();
+      if (root.exception) {
+        std::rethrow_exception(std::exchange(root.exception, nullptr));
+      }
+      if (current.done() && root.leaf->parent) {
+        root.leaf = root.leaf->parent;
+      } else if (root.yielded) {
+        root.yielded = false;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  void reset() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  handle_type handle_ = nullptr;
+};
+
+// Types that serialize writes in one piece
+template<typename T>
+constexpr bool is_written_whole() {
+  return std::is_same<T, std::string>{} || std::is_same<T, jk::intern::interned_string>{} ||
+    refl::is_soa_vector<T>{} || refl::is_byte_buffer<T>{} ||
+    (!metap::is_detected<metap::iterable, T>{} && !refl::is_hot_cold<T>{} &&
+     !refl::is_record<T>{});
+}
+
+template<typename T>
+encoder encode(const T& src, chunk_state& state);
+
+template<typename T>
+encoder encode_array(const T& src, chunk_state& state) {
+  state.buffer += "[ ";
+  for (auto it = src.begin(); it != src.end(); ++it) {
+    const auto& entry = *it;
+    co_await encode(entry, state);
+    if (state.result != serialize_result::success) {
+      co_return;
+    }
+    if (std::next(it) != src.end()) {
+      state.buffer += ", ";
+    }
+    if (state.full()) {
+      co_yield flush{};
+    }
+  }
+  state.buffer += " ]";
+}
+
+template<typename T, std::size_t I>
+encoder encode_member(const T& src, chunk_state& state) {
+  using info = refl::member_info_t<T, I>;
+  if constexpr (I > 0) {
+    state.buffer += ", ";
+  }
+  state.buffer += "\"";
+  state.buffer += std::get<I>(refl::member_list<T>::value).name;
+  state.buffer += "\" : ";
+  return encode(src.*info::pointer, state);
+}
+
+template<typename T, std::size_t ...I>
+constexpr auto member_encoders(std::index_sequence<I...>) {
+  return std::array<encoder (*)(const T&, chunk_state&), sizeof...(I)>{{
+    &encode_member<T, I>...}};
+}
+
+template<typename T>
+encoder encode_record(const T& src, chunk_state& state) {
+  static constexpr auto members =
+    member_encoders<T>(std::make_index_sequence<refl::n_members<T>>{});
+  state.buffer += "{ ";
+  for (auto encode_next : members) {
+    co_await encode_next(src, state);
+    if (state.result != serialize_result::success) {
+      co_return;
+    }
+    if (state.full()) {
+      co_yield flush{};
+    }
+  }
+  state.buffer += " }";
+}
+
+// For records that only exist as a temporary, such as hot_cold::record()
+template<typename T>
+encoder encode_owned_record(T src, chunk_state& state) {
+  co_await encode_record(src, state);
+}
+
+// Scalars are written straight away and only records and arrays start a
+// coroutine
+template<typename T>
+encoder encode(const T& src, chunk_state& state) {
+  if constexpr (is_written_whole<T>()) {
+    state.result = serialize(src, state.buffer);
+    return {};
+  } else if constexpr (refl::is_hot_cold<T>{}) {
+    return encode_owned_record(src.record(), state);
+  } else if constexpr (metap::is_detected<metap::iterable, T>{}) {
+    return encode_array(src, state);
+  } else {
+    return encode_record(src, state);
+  }
+}
+
+}  // namespace chunk_detail
+
+class chunk_stream {
+public:
+  template<typename T>
+  chunk_stream(const T& src, std::size_t chunk_size)
+  : state_(std::make_unique<chunk_detail::chunk_state>()) {
+    state_->chunk_size = chunk_size > 0 ? chunk_size : 1;
+    root_ = chunk_detail::encode(src, *state_);
+  }
+
+  // The next chunk_size bytes, fewer for the last chunk, or an empty view
+  // once everything is written. A chunk stays valid until the next call.
+  std::string_view next() {
+    auto& buffer = state_->buffer;
+    buffer.erase(0, consumed_);
+    consumed_ = 0;
+    while (!state_->full() && root_.step()) {}
+    if (state_->result != serialize_result::success) {
+      buffer.clear();
+    }
+    consumed_ = std::min(buffer.size(), state_->chunk_size);
+    return std::string_view(buffer.data(), consumed_);
+  }
+
+  // Only final once next() has returned an empty view
+  serialize_result result() const {
+    return state_->result;
+  }
+
+private:
+  // On the heap, so the coroutines' references survive a move
+  std::unique_ptr<chunk_detail::chunk_state> state_;
+  chunk_detail::encoder root_;
+  std::size_t consumed_ = 0;
+};
+
+template<typename T>
+chunk_stream serialize_chunks(const T& src, std::size_t chunk_size) {
+  return chunk_stream(src, chunk_size);
+}
+
+}  // namespace reflser
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace reflcompare {
+
+// Specialize to list the members of T that should be compared first, e.g. the
+// ones a compare_profile reports as differing most often:
+//
+//   template<>
+//   struct reflcompare::compare_hint<Record> {
+//     static constexpr std::array<std::string_view, 2> members = {{"id", "kind"}};
+//   };
+template<typename T>
+struct compare_hint {
+  static constexpr std::array<std::string_view, 0> members = {};
+};
+
+}  // namespace reflcompare
+
+namespace jk {
+namespace compare_plan {
+
+// Members that have to chase a pointer (strings, vectors) cost this much, so
+// they sort after every fixed-size member.
+static constexpr std::size_t dynamic_cost = 1 << 20;
+
+template<std::size_t N, std::size_t K>
+constexpr bool hint_is_valid(
+    const std::array<std::string_view, N>& names,
+    const std::array<std::string_view, K>& hint) {
+  for (std::size_t h = 0; h < K; ++h) {
+    bool found = false;
+    for (std::size_t i = 0; i < N; ++i) {
+      found = found || names[i] == hint[h];
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Order in which to compare N members: hinted members first, in hint order,
+// then the rest by increasing cost. Ties keep declaration order.
+template<std::size_t N, std::size_t K>
+constexpr std::array<std::size_t, N> make_order(
+    const std::array<std::size_t, N>& costs,
+    const std::array<std::string_view, N>& names,
+    const std::array<std::string_view, K>& hint) {
+  std::array<std::size_t, N> order = {};
+  std::array<bool, N> placed = {};
+  std::size_t n = 0;
+  for (std::size_t h = 0; h < K; ++h) {
+    for (std::size_t i = 0; i < N; ++i) {
+      if (!placed[i] && names[i] == hint[h]) {
+        order[n++] = i;
+        placed[i] = true;
+        break;
+      }
+    }
+  }
+  while (n < N) {
+    std::size_t best = N;
+    for (std::size_t i = 0; i < N; ++i) {
+      if (!placed[i] && (best == N || costs[i] < costs[best])) {
+        best = i;
+      }
+    }
+    order[n++] = best;
+    placed[best] = true;
+  }
+  return order;
+}
+
+}  // namespace compare_plan
+}  // namespace jk
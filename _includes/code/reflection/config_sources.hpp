@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cctype>
+#include <string_view>
+#include <type_traits>
+
+#include <unistd.h>
+
+#include "mapped_file.hpp"
+#include "member_list.hpp"
+
+extern char** environ;
+
+namespace reflopt {
+namespace config {
+
+// Option sources other than argv. Map is OptionsMap, which provides
+// set_identifier (raw text value) and set_identifier_json (JSON value token)
+// for option identifiers such as "iterations", and find_identifier and
+// set_option for environment variables. Each source is applied in a single
+// pass straight into the options struct and fails on the first value that
+// doesn't convert.
+
+inline bool equal_ignoring_case(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (std::tolower(static_cast<unsigned char>(a[i])) !=
+        std::tolower(static_cast<unsigned char>(b[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline std::string_view trim(std::string_view src) {
+  const auto first = src.find_first_not_of(" \t\r\n");
+  if (first == std::string_view::npos) {
+    return std::string_view();
+  }
+  const auto last = src.find_last_not_of(" \t\r\n");
+  return src.substr(first, last - first + 1);
+}
+
+// Length of the JSON value at the start of src: up to the first ',' or
+// unmatched closing bracket that is not inside a string or a nested value.
+inline std::size_t json_value_length(std::string_view src) {
+  unsigned depth = 0;
+  bool in_string = false;
+  for (std::size_t i = 0; i < src.size(); ++i) {
+    const char c = src[i];
+    if (in_string) {
+      if (c == '\\') {
+        ++i;
+      } else if (c == '"') {
+        in_string = false;
+      }
+      continue;
+    }
+    switch (c) {
+      case '"':
+        in_string = true;
+        break;
+      case '{':
+      case '[':
+        ++depth;
+        break;
+      case '}':
+      case ']':
+        if (depth == 0) {
+          return i;
+        }
+        --depth;
+        break;
+      case ',':
+        if (depth == 0) {
+          return i;
+        }
+        break;
+    }
+  }
+  return src.size();
+}
+
+// { "identifier" : value, ... } with each value decoded by reflser
+template<typename Map, typename OptionsStruct>
+bool apply_json(OptionsStruct& options, std::string_view text) {
+  text = trim(text);
+  if (text.empty() || text.front() != '{') {
+    return false;
+  }
+  text.remove_prefix(1);
+  while (true) {
+    text = trim(text);
+    if (text.empty()) {
+      return false;
+    }
+    if (text.front() == '}') {
+      return true;
+    }
+    if (text.front() != '"') {
+      return false;
+    }
+    text.remove_prefix(1);
+    const auto quote = text.find('"');
+    if (quote == std::string_view::npos) {
+      return false;
+    }
+    const auto key = text.substr(0, quote);
+    text = trim(text.substr(quote + 1));
+    if (text.empty() || text.front() != ':') {
+      return false;
+    }
+    text.remove_prefix(1);
+
+    const auto length = json_value_length(text);
+    if (!Map::set_identifier_json(options, key, trim(text.substr(0, length)))) {
+      return false;
+    }
+    text = trim(text.substr(length));
+    if (!text.empty() && text.front() == ',') {
+      text.remove_prefix(1);
+    }
+  }
+}
+
+// identifier = value, one per line; blank lines and lines starting with '#'
+// are skipped
+template<typename Map, typename OptionsStruct>
+bool apply_key_value(OptionsStruct& options, std::string_view text) {
+  while (!text.empty()) {
+    const auto eol = text.find('\n');
+    const auto line = trim(text.substr(0, eol));
+    text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    const auto eq = line.find('=');
+    if (eq == std::string_view::npos ||
+        !Map::set_identifier(options, trim(line.substr(0, eq)), trim(line.substr(eq + 1)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename OptionsStruct>
+constexpr bool has_string_view_member() {
+  bool found = false;
+  jk::refl_utilities::for_each_member<OptionsStruct>([&found](const auto& member) {
+    using info = std::decay_t<decltype(member)>;
+    found = found || std::is_same<typename info::type, std::string_view>{};
+  });
+  return found;
+}
+
+// JSON if the file starts with '{', key=value otherwise. The file is only
+// mapped for the duration of the call, so options loaded from it must own
+// their text.
+template<typename Map, typename OptionsStruct>
+bool apply_file(OptionsStruct& options, const char* path) {
+  static_assert(!has_string_view_member<OptionsStruct>(),
+    "std::string_view options would point into the unmapped config file; use std::string.");
+  jk::mapped_file::mapped_file file;
+  if (!file.open(path)) {
+    return false;
+  }
+  const auto text = trim(file.view());
+  if (!text.empty() && text.front() == '{') {
+    return apply_json<Map>(options, text);
+  }
+  return apply_key_value<Map>(options, text);
+}
+
+// PREFIX_ITERATIONS=5 sets the option with identifier "iterations"; the
+// identifier is matched ignoring case. Other variables that happen to share
+// the prefix are ignored.
+template<typename Map, typename OptionsStruct>
+bool apply_environment(OptionsStruct& options, std::string_view prefix) {
+  for (char** env = environ; *env != nullptr; ++env) {
+    std::string_view entry(*env);
+    if (entry.size() <= prefix.size() + 1 || entry.substr(0, prefix.size()) != prefix ||
+        entry[prefix.size()] != '_') {
+      continue;
+    }
+    entry.remove_prefix(prefix.size() + 1);
+    const auto eq = entry.find('=');
+    if (eq == std::string_view::npos) {
+      continue;
+    }
+    const auto index = Map::find_identifier(entry.substr(0, eq), true);
+    if (index != Map::n_options && !Map::set_option(options, index, entry.substr(eq + 1))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace config
+}  // namespace reflopt
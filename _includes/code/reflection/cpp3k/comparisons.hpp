@@ -1,28 +1,7 @@
 #pragma once
 
-#include "meta_utilities.hpp"
+// Records are compared member by member through member_list, which
+// refl_utilities.hpp specializes
+#include "../ordering.hpp"
+#include "../record_compare.hpp"
 #include "refl_utilities.hpp"
-
-
-namespace reflcompare {
-
-namespace refl = jk::refl_utilities;
-namespace metap = jk::metaprogramming;
-namespace meta = cpp3k::meta;
-
-template<typename T>
-bool equal(const T& a, const T& b) {
-  if constexpr (metap::is_detected<metap::equality_comparable, T>{}) {
-    return a == b;
-  } else {
-    bool result = true;
-    meta::for_each($T.member_variables(),
-      [&a, &b, &result](auto&& member){
-        result &= equal(a.*member.pointer(), b.*member.pointer());
-      }
-    );
-    return result;
-  }
-}
-
-}  // namespace reflcompare
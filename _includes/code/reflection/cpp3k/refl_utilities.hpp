@@ -1,9 +1,19 @@
 #pragma once
 
 #include "../meta_utilities.hpp"
+#include "../hot_cold.hpp"
+#include "../member_key.hpp"
+#include "../member_list.hpp"
+#include "../name_index.hpp"
+#include "../soa_vector.hpp"
 #include "../string_literal.hpp"
 #include <cpp3k/meta>
 
+#include <array>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
 #include <cpp3k/detail/tuple.hpp>
 
 namespace jk {
@@ -16,24 +26,59 @@ namespace sl = jk::string_literal;
 template<typename T>
 using has_member_variables = std::void_t<decltype($T.member_variables())>;
 
-template<typename T>
-static constexpr bool is_member_type() {
-  return metap::is_detected<has_member_variables, T>{};
+template<typename T, std::size_t ...I>
+constexpr auto member_names(std::index_sequence<I...>) {
+  return std::array<std::string_view, sizeof...(I)>{{
+    meta::cget<I>($T.member_variables()).name()...}};
 }
 
+template<typename T, std::size_t ...I>
+constexpr auto member_type_names(std::index_sequence<I...>) {
+  return std::array<std::string_view, sizeof...(I)>{{
+    meta::cget<I>($T.member_variables()).type_name()...}};
+}
+
+// Shared by every lookup on T, so each table is built once per type
+template<typename T>
+inline constexpr auto member_index = make_name_index(
+  member_names<T>(std::make_index_sequence<$T.member_variables().size()>{}));
+
+template<typename T>
+inline constexpr auto member_type_index = make_name_index(
+  member_type_names<T>(std::make_index_sequence<$T.member_variables().size()>{}));
+
 template<typename T, typename StrT>
 static constexpr bool has_member(StrT&& key) {
-  bool has_member = false;
-  meta::for_each($T.member_variables(),
-    [&key, &has_member](auto&& member) {
-      if constexpr (sl::equal(key, member.type_name())) {
-        has_member = true;
-      }
-    }
-  );
-  return has_member;
+  return member_type_index<T>.contains(key);
 }
 
+template<typename T, typename StrT>
+static constexpr std::size_t index_of_member(StrT&& key) {
+  return member_index<T>.find(key);
+}
+
+template<typename T, auto Str>
+constexpr auto get_member_pointer() {
+  constexpr auto index = member_index<T>.find(Str);
+  static_assert(index != member_index<T>.npos, "Type has no data member with this name.");
+  return meta::cget<index>($T.member_variables()).pointer();
+}
+
+template<typename T, std::size_t ...I>
+constexpr auto member_info_tuple(std::index_sequence<I...>) {
+  return std::make_tuple(
+    member_info<meta::cget<I>($T.member_variables()).pointer()>{
+      meta::cget<I>($T.member_variables()).name(),
+      meta::cget<I>($T.member_variables()).type_name()
+    }...);
+}
+
+template<typename T>
+struct member_list<T, has_member_variables<T>> {
+  static constexpr auto value = member_info_tuple<T>(
+    std::make_index_sequence<$T.member_variables().size()>{});
+};
+
 template<typename S, typename Member>
 using unreflect_member_t = typename std::decay_t<
     decltype(std::declval<S>().*(std::decay_t<Member>::pointer()))>;
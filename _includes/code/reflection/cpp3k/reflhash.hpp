@@ -0,0 +1,7 @@
+#pragma once
+
+// Records are hashed member by member through member_list, which
+// refl_utilities.hpp specializes; equal_to uses comparisons.hpp
+#include "../record_hash.hpp"
+#include "comparisons.hpp"
+#include "refl_utilities.hpp"
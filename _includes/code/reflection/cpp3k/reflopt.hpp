@@ -4,36 +4,32 @@
 #include <boost/hana/filter.hpp>
 #include <boost/hana/fold.hpp>
 #include <boost/hana/for_each.hpp>
+#include <boost/hana/length.hpp>
 #include <boost/hana/map.hpp>
 #include <boost/hana/string.hpp>
 #include <boost/hana/tuple.hpp>
 
 #include <boost/lexical_cast.hpp>
 
-#include <experimental/optional>
+#include <cstring>
+#include <string_view>
 
+// parse and the other entry points live in option_parser.hpp and find the
+// options through member_list. PrefixMap is the older hana map lookup, kept
+// for the compile-time comparison in benchmarks/options_compile_time.cpp.
 #include "refl_utilities.hpp"
+#include "refldiff.hpp"
+#include "reflser.hpp"
+#include "../option_parser.hpp"
 #include "meta_utilities.hpp"
 
-#include <vrm/pp/arg_count.hpp>
-#include <vrm/pp/cat.hpp>
-
-#include <boost/hana/length.hpp>
-
-#include <iostream>
-
 #include "cpp3k/adapt_hana.hpp"
 
 namespace reflopt {
-  static const size_t max_value_length = 128;
-
   namespace refl = jk::refl_utilities;
   namespace metap = jk::metaprogramming;
   namespace hana = boost::hana;
 
-  template<typename T>
-  using optional_t = std::experimental::optional<T>;
-
   // Compare a hana string to a const char*
   template<typename Str>
   bool runtime_string_compare(const Str&, const char* x) {
@@ -65,17 +61,11 @@ namespace reflopt {
     return cpp3k::meta::cget<index>($T.member_variables());
   }
 
-  template<typename Id, typename Flag, typename ShortFlag, typename Help>
-  struct Option
-  {
-    static constexpr Id identifier;
-    static constexpr Flag flag;
-    static constexpr ShortFlag short_flag;
-    static constexpr Help help;
-  };
-
+  // Flag lookup through a compile-time hana map, one insertion per flag.
+  // Straightforward, but instantiation cost grows quickly with the number of
+  // options; parse goes through the flat arrays of OptionsMap instead.
   template<typename OptionsStruct>
-  struct OptionsMap {
+  struct PrefixMap {
     static constexpr auto collect_flags = [](auto&& x, auto&& field) {
       using T = refl::unreflect_member_t<OptionsStruct, decltype(field)>;
       auto result = hana::insert(
@@ -125,64 +115,11 @@ namespace reflopt {
             constexpr auto member_pointer = info.pointer();
             using MemberType = refl::unreflect_member_t<OptionsStruct, decltype(info)>;
             options.*member_pointer = boost::lexical_cast<MemberType>(
-              value, strnlen(value, max_value_length));
+              value, strlen(value));
           }
         }
       );
     }
   };
 
-  // ArgVT boilerplate is to enable both char** and const char*[]'s for testing
-  template<typename OptionsStruct, typename ArgVT,
-    typename std::enable_if_t<
-      std::is_same<ArgVT, char**>{} || std::is_same<ArgVT, const char**>{}>* = nullptr
-  >
-  optional_t<OptionsStruct> parse(int argc, ArgVT const argv) {
-    OptionsStruct options;
-    for (int i = 1; i < argc; i += 2) {
-      if (OptionsMap<OptionsStruct>::contains(argv[i])) {
-          OptionsMap<OptionsStruct>::set(options, argv[i], argv[i + 1]);
-      } else {
-        // unknown prefix found
-        return std::experimental::nullopt;
-      }
-    }
-
-    return options;
-  }
-
-template<size_t N>
-struct hana_string_from_literal {
-  static constexpr auto apply(const char (&literal)[N]) {
-    return apply_helper(literal, std::make_index_sequence<N>{});
-  }
-
-  template<size_t ...I>
-  static constexpr auto apply_helper(const char (&literal)[N], std::index_sequence<I...>&&) {
-    return hana::string_c<literal[I]...>;
-  }
-};
-
 }  // namespace reflopt
-
-
-#define BOOST_HANA_STRING_T(Literal) \
-  decltype(Literal ## _s)
-
-#define REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, Help) \
-  reflopt::Option<BOOST_HANA_STRING_T(#Identifier), BOOST_HANA_STRING_T(Flag), \
-      BOOST_HANA_STRING_T(ShortFlag), BOOST_HANA_STRING_T(Help)> \
-    reflopt_ ## Identifier ## _tag; \
-  Type Identifier
-
-#define REFLOPT_OPTION_3(Type, Identifier, Flag) \
-  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, "", "")
-
-#define REFLOPT_OPTION_4(Type, Identifier, Flag, ShortFlag) \
-  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, "")
-
-#define REFLOPT_OPTION_5(Type, Identifier, Flag, ShortFlag, Help) \
-  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, Help)
-
-#define REFLOPT_OPTION(...) \
-  VRM_PP_CAT(REFLOPT_OPTION_, VRM_PP_ARGCOUNT(__VA_ARGS__))(__VA_ARGS__) \
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bytewise_compare.hpp"
+#include "hot_cold.hpp"
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+#include "ordering.hpp"
+#include "parallel_utilities.hpp"
+#include "soa_vector.hpp"
+
+namespace refldiff {
+
+namespace metap = jk::metaprogramming;
+namespace parallel = jk::parallel_utilities;
+namespace refl = jk::refl_utilities;
+
+template<typename T>
+using indexable = decltype(std::declval<const T&>()[0], std::declval<const T&>().size());
+
+// Appends the paths of the members that differ between a and b, such as
+// "address.city" or "samples[3]"
+template<typename T>
+void member_diff(const T& a, const T& b, const std::string& path,
+    std::vector<std::string>& out) {
+  if (reflcompare::equal(a, b)) {
+    return;
+  }
+  if constexpr (std::is_same<T, std::string>{}) {
+    out.push_back(path);
+  } else if constexpr (refl::is_hot_cold<T>{}) {
+    member_diff(a.record(), b.record(), path, out);
+  } else if constexpr (refl::is_soa_vector<T>{}) {
+    // Elements are proxies, so each one is gathered back into a record
+    if (a.size() != b.size()) {
+      out.push_back(path);
+      return;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      member_diff(a.get(i), b.get(i), path + "[" + std::to_string(i) + "]", out);
+    }
+  } else if constexpr (metap::is_detected<indexable, T>{}) {
+    // Same-length sequences are diffed element by element
+    if (a.size() != b.size()) {
+      out.push_back(path);
+      return;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      member_diff(a[i], b[i], path + "[" + std::to_string(i) + "]", out);
+    }
+  } else if constexpr (refl::is_record<T>{} &&
+                       !metap::is_detected<metap::equality_comparable, T>{}) {
+    refl::for_each_member<T>([&a, &b, &path, &out](const auto& member) {
+      const std::string name(member.name);
+      member_diff(a.*member.pointer, b.*member.pointer,
+        path.empty() ? name : path + "." + name, out);
+    });
+  } else {
+    out.push_back(path);
+  }
+}
+
+enum struct change_kind {
+  added,
+  removed,
+  modified
+};
+
+template<typename T>
+struct record_diff {
+  change_kind kind;
+  // Only valid for the duration of the callback. left is null for added
+  // records, right is null for removed records.
+  const T* left;
+  const T* right;
+  // Empty unless kind is modified
+  std::vector<std::string> paths;
+};
+
+enum struct diff_result {
+  success,
+  unsorted_input
+};
+
+struct diff_options {
+  // Records buffered before the pairs are compared. Memory use is bounded by
+  // about twice this many records, independent of the input size.
+  std::size_t batch_size = 1 << 14;
+  unsigned threads = parallel::default_threads();
+};
+
+struct diff_stats {
+  std::size_t added = 0;
+  std::size_t removed = 0;
+  std::size_t modified = 0;
+  std::size_t unchanged = 0;
+};
+
+// Streams two inputs sorted by KeyMember, matching records with equal keys.
+// Matched pairs are compared in parallel a batch at a time, and callback is
+// invoked with every difference in key order from the calling thread.
+template<auto KeyMember, typename LeftIt, typename RightIt, typename Callback>
+diff_result diff_sorted(LeftIt left_first, LeftIt left_last,
+    RightIt right_first, RightIt right_last,
+    Callback&& callback, diff_stats& stats, const diff_options& options = {}) {
+  using T = std::decay_t<decltype(*left_first)>;
+  using key_t = std::decay_t<decltype(std::declval<const T&>().*KeyMember)>;
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  struct event {
+    change_kind kind;
+    std::size_t left;
+    std::size_t right;
+  };
+
+  std::vector<T> left;
+  std::vector<T> right;
+  std::vector<event> events;
+  std::vector<std::vector<std::string>> paths;
+
+  auto flush = [&]() {
+    paths.resize(events.size());
+    parallel::parallel_for(events.size(), 256, options.threads,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          if (events[i].kind == change_kind::modified) {
+            member_diff(left[events[i].left], right[events[i].right], "", paths[i]);
+          }
+        }
+      });
+
+    for (std::size_t i = 0; i < events.size(); ++i) {
+      const auto& e = events[i];
+      if (e.kind == change_kind::modified && paths[i].empty()) {
+        ++stats.unchanged;
+        continue;
+      }
+      switch (e.kind) {
+        case change_kind::added:
+          ++stats.added;
+          break;
+        case change_kind::removed:
+          ++stats.removed;
+          break;
+        case change_kind::modified:
+          ++stats.modified;
+          break;
+      }
+      callback(record_diff<T>{e.kind,
+        e.left == npos ? nullptr : &left[e.left],
+        e.right == npos ? nullptr : &right[e.right],
+        std::move(paths[i])});
+    }
+
+    left.clear();
+    right.clear();
+    events.clear();
+    paths.clear();
+  };
+
+  std::optional<key_t> last_left;
+  std::optional<key_t> last_right;
+  auto in_order = [](std::optional<key_t>& last, const key_t& key) {
+    if (last && reflcompare::compare_values(key, *last) < 0) {
+      return false;
+    }
+    last = key;
+    return true;
+  };
+
+  while (left_first != left_last || right_first != right_last) {
+    int order;
+    if (left_first == left_last) {
+      order = 1;
+    } else if (right_first == right_last) {
+      order = -1;
+    } else {
+      order = reflcompare::compare_values((*left_first).*KeyMember, (*right_first).*KeyMember);
+    }
+
+    if (order <= 0) {
+      left.push_back(*left_first);
+      ++left_first;
+      if (!in_order(last_left, left.back().*KeyMember)) {
+        flush();
+        return diff_result::unsorted_input;
+      }
+    }
+    if (order >= 0) {
+      right.push_back(*right_first);
+      ++right_first;
+      if (!in_order(last_right, right.back().*KeyMember)) {
+        flush();
+        return diff_result::unsorted_input;
+      }
+    }
+
+    if (order < 0) {
+      events.push_back(event{change_kind::removed, left.size() - 1, npos});
+    } else if (order > 0) {
+      events.push_back(event{change_kind::added, npos, right.size() - 1});
+    } else {
+      events.push_back(event{change_kind::modified, left.size() - 1, right.size() - 1});
+    }
+
+    if (events.size() >= options.batch_size) {
+      flush();
+    }
+  }
+  flush();
+  return diff_result::success;
+}
+
+}  // namespace refldiff
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "member_key.hpp"
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+#include "soa_vector.hpp"
+
+namespace jk {
+namespace refl_utilities {
+
+namespace hot_cold_detail {
+
+template<auto A, auto B>
+constexpr bool same_member() {
+  if constexpr (std::is_same<std::decay_t<decltype(A)>, std::decay_t<decltype(B)>>{}) {
+    return A == B;
+  } else {
+    return false;
+  }
+}
+
+template<auto ...Hot>
+struct hot_list {};
+
+// Position of member I of T among Hot, or sizeof...(Hot) if it's cold
+template<typename T, std::size_t I, auto ...Hot>
+constexpr std::size_t hot_position() {
+  constexpr auto member = std::get<I>(member_pointers<T>::value);
+  std::size_t result = sizeof...(Hot);
+  std::size_t j = 0;
+  static_cast<void>(((result = same_member<member, member_of<T, Hot>()>() ? j : result, ++j), ...));
+  return result;
+}
+
+template<typename T, auto ...Hot, std::size_t ...I>
+constexpr auto hot_positions(hot_list<Hot...>, std::index_sequence<I...>) {
+  return std::array<std::size_t, sizeof...(I)>{{hot_position<T, I, Hot...>()...}};
+}
+
+// Cold members are numbered in declaration order; hot ones get N
+template<std::size_t N>
+constexpr std::array<std::size_t, N> cold_positions(const std::array<std::size_t, N>& hot,
+    std::size_t n_hot) {
+  std::array<std::size_t, N> result = {};
+  std::size_t next = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    result[i] = hot[i] == n_hot ? next++ : N;
+  }
+  return result;
+}
+
+template<std::size_t N>
+constexpr std::size_t count_below(const std::array<std::size_t, N>& positions, std::size_t n) {
+  std::size_t result = 0;
+  for (auto position : positions) {
+    result += position < n;
+  }
+  return result;
+}
+
+// The member index in each of K positions
+template<std::size_t K, std::size_t N>
+constexpr std::array<std::size_t, K> members_at(const std::array<std::size_t, N>& positions) {
+  std::array<std::size_t, K> result = {};
+  for (std::size_t i = 0; i < N; ++i) {
+    if (positions[i] < K) {
+      result[positions[i]] = i;
+    }
+  }
+  return result;
+}
+
+// False unless a and b are known to hold the same value. Trivially copyable
+// members are compared by representation, so -0.0 isn't taken for 0.0.
+template<typename M>
+bool same_value(const M& a, const M& b) {
+  if constexpr (std::is_trivially_copyable<M>{}) {
+    return std::memcmp(&a, &b, sizeof(M)) == 0;
+  } else if constexpr (metaprogramming::is_detected<metaprogramming::equality_comparable, M>{}) {
+    return a == b;
+  } else {
+    return false;
+  }
+}
+
+}  // namespace hot_cold_detail
+
+// Holds a T with the Hot members inline and the rest in a separate
+// allocation, so arrays of hot_cold<T, ...> only pull the hot members into
+// cache. Hot members are named by pointer or name, as in member_of.
+//
+// hot_cold<request, &request::id, &request::latency> r = request_from_wire();
+// r.get<&request::latency>() += 1;
+// request whole = r.record();
+//
+// Until a cold member is written, the cold part isn't allocated and reads
+// return T's default member values. Converting from a T allocates it only if
+// one of the cold members differs from its default.
+template<typename T, auto ...Hot>
+class hot_cold {
+  static constexpr auto pointers = member_pointers<T>::value;
+
+public:
+  using value_type = T;
+
+  static constexpr std::size_t n_members = std::tuple_size<std::decay_t<decltype(pointers)>>{};
+  static constexpr std::size_t n_hot = sizeof...(Hot);
+  static constexpr std::size_t n_cold = n_members - n_hot;
+
+  // Position of each member in the hot or cold part, or n_hot / n_members
+  static constexpr auto hot_slots = hot_cold_detail::hot_positions<T>(
+    hot_cold_detail::hot_list<Hot...>{}, std::make_index_sequence<n_members>{});
+  static constexpr auto cold_slots = hot_cold_detail::cold_positions(hot_slots, n_hot);
+  static constexpr auto hot_members = hot_cold_detail::members_at<n_hot>(hot_slots);
+  static constexpr auto cold_members = hot_cold_detail::members_at<n_cold>(cold_slots);
+
+  template<std::size_t I>
+  using member_t = member_type_t<std::get<I>(pointers)>;
+
+private:
+  static_assert(hot_cold_detail::count_below(hot_slots, n_hot) == n_hot,
+    "Hot names a member twice or something that isn't a data member of T.");
+
+  template<std::size_t ...K>
+  static auto make_hot(std::index_sequence<K...>) -> std::tuple<member_t<hot_members[K]>...>;
+  template<std::size_t ...K>
+  static auto make_cold(std::index_sequence<K...>) -> std::tuple<member_t<cold_members[K]>...>;
+
+  using hot_t = decltype(make_hot(std::make_index_sequence<n_hot>{}));
+  using cold_t = decltype(make_cold(std::make_index_sequence<n_cold>{}));
+
+public:
+  hot_cold() : hot_(hot_from(defaults(), std::make_index_sequence<n_hot>{})) {}
+
+  hot_cold(const T& value) : hot_(hot_from(value, std::make_index_sequence<n_hot>{})) {
+    if (!cold_is_default(value, std::make_index_sequence<n_cold>{})) {
+      cold_ = std::make_unique<cold_t>(cold_from(value, std::make_index_sequence<n_cold>{}));
+    }
+  }
+
+  hot_cold(const hot_cold& other)
+  : hot_(other.hot_), cold_(other.cold_ ? std::make_unique<cold_t>(*other.cold_) : nullptr) {}
+
+  hot_cold(hot_cold&&) = default;
+
+  hot_cold& operator=(hot_cold other) {
+    std::swap(hot_, other.hot_);
+    std::swap(cold_, other.cold_);
+    return *this;
+  }
+
+  hot_cold& operator=(const T& value) {
+    return *this = hot_cold(value);
+  }
+
+  template<auto Key>
+  static constexpr std::size_t index_of() {
+    return index_of_member<member_of<T, Key>()>(std::make_index_sequence<n_members>{});
+  }
+
+  template<std::size_t I>
+  static constexpr bool is_hot() {
+    return hot_slots[I] < n_hot;
+  }
+
+  // Writing through a cold reference allocates the cold part
+  template<std::size_t I>
+  member_t<I>& get_at() {
+    if constexpr (is_hot<I>()) {
+      return std::get<hot_slots[I]>(hot_);
+    } else {
+      return std::get<cold_slots[I]>(cold());
+    }
+  }
+  template<std::size_t I>
+  const member_t<I>& get_at() const {
+    if constexpr (is_hot<I>()) {
+      return std::get<hot_slots[I]>(hot_);
+    } else {
+      return std::get<cold_slots[I]>(cold());
+    }
+  }
+
+  template<auto Key>
+  auto& get() {
+    constexpr auto index = index_of<Key>();
+    static_assert(index < n_members, "Not a data member of T.");
+    return get_at<index>();
+  }
+  template<auto Key>
+  const auto& get() const {
+    constexpr auto index = index_of<Key>();
+    static_assert(index < n_members, "Not a data member of T.");
+    return get_at<index>();
+  }
+
+  bool has_cold() const {
+    return cold_ != nullptr;
+  }
+
+  // Gathers the members back into a T
+  T record() const {
+    T result;
+    assign_to(result, std::make_index_sequence<n_members>{});
+    return result;
+  }
+
+  // pred(mine, theirs) for each member, hot ones first, until it returns false
+  template<typename F>
+  bool equal_members(const hot_cold& other, F&& pred) const {
+    if (!equal_hot(other, pred, std::make_index_sequence<n_hot>{})) {
+      return false;
+    }
+    if (!cold_ && !other.cold_) {
+      return true;
+    }
+    return equal_cold(other, pred, std::make_index_sequence<n_cold>{});
+  }
+
+private:
+  static const T& defaults() {
+    static const T value{};
+    return value;
+  }
+
+  static const cold_t& cold_defaults() {
+    static const cold_t value = cold_from(defaults(), std::make_index_sequence<n_cold>{});
+    return value;
+  }
+
+  template<auto Member, std::size_t ...I>
+  static constexpr std::size_t index_of_member(std::index_sequence<I...>) {
+    std::size_t result = n_members;
+    static_cast<void>(((result = hot_cold_detail::same_member<Member, std::get<I>(pointers)>() ?
+      I : result), ...));
+    return result;
+  }
+
+  template<std::size_t ...K>
+  static hot_t hot_from(const T& value, std::index_sequence<K...>) {
+    return hot_t(value.*std::get<hot_members[K]>(pointers)...);
+  }
+  template<std::size_t ...K>
+  static cold_t cold_from(const T& value, std::index_sequence<K...>) {
+    return cold_t(value.*std::get<cold_members[K]>(pointers)...);
+  }
+
+  template<std::size_t ...K>
+  static bool cold_is_default(const T& value, std::index_sequence<K...>) {
+    return (hot_cold_detail::same_value(value.*std::get<cold_members[K]>(pointers),
+      defaults().*std::get<cold_members[K]>(pointers)) && ...);
+  }
+
+  cold_t& cold() {
+    if (!cold_) {
+      cold_ = std::make_unique<cold_t>(cold_defaults());
+    }
+    return *cold_;
+  }
+  const cold_t& cold() const {
+    return cold_ ? *cold_ : cold_defaults();
+  }
+
+  template<std::size_t ...I>
+  void assign_to(T& result, std::index_sequence<I...>) const {
+    static_cast<void>(((result.*std::get<I>(pointers) = get_at<I>()), ...));
+  }
+
+  template<typename F, std::size_t ...K>
+  bool equal_hot(const hot_cold& other, F& pred, std::index_sequence<K...>) const {
+    return (pred(std::get<K>(hot_), std::get<K>(other.hot_)) && ...);
+  }
+  template<typename F, std::size_t ...K>
+  bool equal_cold(const hot_cold& other, F& pred, std::index_sequence<K...>) const {
+    const cold_t& mine = cold();
+    const cold_t& theirs = other.cold();
+    return (pred(std::get<K>(mine), std::get<K>(theirs)) && ...);
+  }
+
+  hot_t hot_;
+  std::unique_ptr<cold_t> cold_;
+};
+
+template<typename T>
+struct is_hot_cold : std::false_type {};
+template<typename T, auto ...Hot>
+struct is_hot_cold<hot_cold<T, Hot...>> : std::true_type {};
+
+}  // namespace refl_utilities
+}  // namespace jk
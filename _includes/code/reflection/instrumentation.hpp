@@ -0,0 +1,329 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-type counters for reflser, reflcompare and reflopt. Off unless
+// REFLSTATS_ENABLE is defined to 1, in which case every serialize,
+// deserialize, equal and parse of a class type counts its calls, bytes
+// written or consumed, heap allocations and cycles. Counts are inclusive: a
+// record's cycles include those of its members.
+//
+// The codecs are templates and inline functions, so REFLSTATS_ENABLE and
+// REFLSTATS_MAX_TYPES must be the same in every translation unit of a
+// program. Set them on the compiler command line (-DREFLSTATS_ENABLE=1) for
+// the whole build, never with a #define in a source file: mixed settings
+// break the one definition rule and the linker keeps whichever copy it sees
+// first.
+//
+// reflstats::report stats = reflstats::snapshot();
+// std::string json;
+// reflser::serialize(stats, json);
+//
+// Allocations are only counted in programs that expand
+// REFLSTATS_COUNT_ALLOCATIONS() once, at namespace scope in one source file,
+// to replace the global operator new, including the aligned overloads that
+// soa_vector's columns allocate through.
+#ifndef REFLSTATS_ENABLE
+#define REFLSTATS_ENABLE 0
+#endif
+
+#ifndef REFLSTATS_MAX_TYPES
+#define REFLSTATS_MAX_TYPES 256
+#endif
+
+namespace reflstats {
+
+struct codec_stats {
+  std::uint64_t calls;
+  std::uint64_t bytes;
+  std::uint64_t allocations;
+  // rdtsc ticks on x86, nanoseconds elsewhere
+  std::uint64_t cycles;
+};
+
+struct type_stats {
+  std::string type;
+  codec_stats serialize;
+  codec_stats deserialize;
+  codec_stats equal;
+  codec_stats parse;
+};
+
+// Types that were never counted are left out
+struct report {
+  std::vector<type_stats> types;
+};
+
+enum struct operation {
+  serialize,
+  deserialize,
+  equal,
+  parse
+};
+
+}  // namespace reflstats
+
+#if REFLSTATS_ENABLE
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+namespace reflstats {
+
+namespace detail {
+
+static constexpr std::size_t n_operations = 4;
+static constexpr std::size_t n_counters = 4;
+// Types registered past the limit share the last slot
+static constexpr std::size_t max_types = REFLSTATS_MAX_TYPES;
+
+inline std::uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline std::uint64_t& thread_allocations() {
+  static thread_local std::uint64_t count = 0;
+  return count;
+}
+
+inline std::string type_name(const std::type_info& info) {
+#if __has_include(<cxxabi.h>)
+  int status = 0;
+  std::unique_ptr<char, void (*)(void*)> demangled(
+    abi::__cxa_demangle(info.name(), nullptr, nullptr, &status), std::free);
+  if (status == 0 && demangled) {
+    return demangled.get();
+  }
+#endif
+  return info.name();
+}
+
+// Written only by the owning thread, so relaxed loads and stores are enough
+// and snapshot() can read them at any time
+struct slots {
+  std::array<std::atomic<std::uint64_t>, max_types * n_operations * n_counters> counts = {};
+
+  void add(std::size_t type, operation op, std::uint64_t bytes, std::uint64_t allocations,
+      std::uint64_t cycles) {
+    auto* counter = &counts[(type * n_operations + static_cast<std::size_t>(op)) * n_counters];
+    const std::uint64_t deltas[n_counters] = {1, bytes, allocations, cycles};
+    for (std::size_t i = 0; i < n_counters; ++i) {
+      counter[i].store(counter[i].load(std::memory_order_relaxed) + deltas[i],
+        std::memory_order_relaxed);
+    }
+  }
+};
+
+class registry {
+public:
+  static registry& instance() {
+    // Leaked, so threads that exit during static destruction can still detach
+    static registry* value = new registry;
+    return *value;
+  }
+
+  std::size_t register_type(std::string name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    names_.push_back(std::move(name));
+    return std::min(names_.size() - 1, max_types - 1);
+  }
+
+  void attach(const slots* s) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_.push_back(s);
+  }
+
+  // The counts of exited threads are kept in retired_
+  void detach(const slots* s) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t i = 0; i < retired_.size(); ++i) {
+      retired_[i] += s->counts[i].load(std::memory_order_relaxed);
+    }
+    live_.erase(std::find(live_.begin(), live_.end(), s));
+  }
+
+  report merge() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto totals = retired_;
+    for (const slots* s : live_) {
+      for (std::size_t i = 0; i < totals.size(); ++i) {
+        totals[i] += s->counts[i].load(std::memory_order_relaxed);
+      }
+    }
+
+    report result;
+    const std::size_t n_types = std::min(names_.size(), max_types);
+    for (std::size_t type = 0; type < n_types; ++type) {
+      const std::uint64_t* counts = &totals[type * n_operations * n_counters];
+      auto stats = [counts](operation op) {
+        const std::uint64_t* c = counts + static_cast<std::size_t>(op) * n_counters;
+        return codec_stats{c[0], c[1], c[2], c[3]};
+      };
+      type_stats entry{type == max_types - 1 && names_.size() > max_types ? "(other)" :
+          names_[type], stats(operation::serialize), stats(operation::deserialize),
+        stats(operation::equal), stats(operation::parse)};
+      if (entry.serialize.calls || entry.deserialize.calls || entry.equal.calls ||
+          entry.parse.calls) {
+        result.types.push_back(std::move(entry));
+      }
+    }
+    return result;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<std::string> names_;
+  std::vector<const slots*> live_;
+  std::array<std::uint64_t, max_types * n_operations * n_counters> retired_ = {};
+};
+
+struct thread_slots {
+  std::unique_ptr<slots> value = std::make_unique<slots>();
+
+  thread_slots() {
+    registry::instance().attach(value.get());
+  }
+
+  ~thread_slots() {
+    registry::instance().detach(value.get());
+  }
+};
+
+inline slots& local_slots() {
+  static thread_local thread_slots s;
+  return *s.value;
+}
+
+template<typename T>
+std::size_t type_id() {
+  static const std::size_t id = registry::instance().register_type(type_name(typeid(T)));
+  return id;
+}
+
+}  // namespace detail
+
+// Counts one call on T from construction to destruction. size() is read at
+// both ends and the difference is counted as bytes.
+template<typename T, typename SizeF, bool Counted = std::is_class<T>{}>
+class scope {
+public:
+  scope(operation op, SizeF size)
+  : op_(op), size_(size), start_size_(size_()),
+    start_allocations_(detail::thread_allocations()), start_cycles_(detail::now()) {}
+
+  scope(const scope&) = delete;
+  scope& operator=(const scope&) = delete;
+
+  ~scope() {
+    const std::uint64_t cycles = detail::now() - start_cycles_;
+    const std::size_t end_size = size_();
+    const std::size_t bytes = end_size > start_size_ ? end_size - start_size_ :
+      start_size_ - end_size;
+    detail::local_slots().add(detail::type_id<T>(), op_, bytes,
+      detail::thread_allocations() - start_allocations_, cycles);
+  }
+
+private:
+  operation op_;
+  SizeF size_;
+  std::size_t start_size_;
+  std::uint64_t start_allocations_;
+  std::uint64_t start_cycles_;
+};
+
+// Scalars and other non-class types aren't counted
+template<typename T, typename SizeF>
+class scope<T, SizeF, false> {
+public:
+  scope(operation, SizeF) {}
+};
+
+template<typename T, typename SizeF>
+scope<T, SizeF> make_scope(operation op, SizeF size) {
+  return scope<T, SizeF>(op, size);
+}
+
+// Totals over every thread, including ones that have exited
+inline report snapshot() {
+  return detail::registry::instance().merge();
+}
+
+}  // namespace reflstats
+
+#define REFLSTATS_CONCAT_HELPER(a, b) a ## b
+#define REFLSTATS_CONCAT(a, b) REFLSTATS_CONCAT_HELPER(a, b)
+
+// Counts the rest of the enclosing block as one Op on Type. Size is an
+// expression whose change over the block is the number of bytes.
+#define REFLSTATS_SCOPE(Type, Op, Size) \
+  [[maybe_unused]] auto REFLSTATS_CONCAT(reflstats_scope_, __LINE__) = \
+    reflstats::make_scope<Type>( \
+      reflstats::operation::Op, [&]() -> std::size_t { return (Size); })
+
+#define REFLSTATS_COUNT_ALLOCATIONS() \
+  void* operator new(std::size_t size) { \
+    ++reflstats::detail::thread_allocations(); \
+    if (void* p = std::malloc(size ? size : 1)) { \
+      return p; \
+    } \
+    throw std::bad_alloc(); \
+  } \
+  void operator delete(void* p) noexcept { \
+    std::free(p); \
+  } \
+  void operator delete(void* p, std::size_t) noexcept { \
+    std::free(p); \
+  } \
+  void* operator new(std::size_t size, std::align_val_t align) { \
+    ++reflstats::detail::thread_allocations(); \
+    const auto alignment = static_cast<std::size_t>(align); \
+    if (void* p = std::aligned_alloc(alignment, \
+          ((size ? size : 1) + alignment - 1) / alignment * alignment)) { \
+      return p; \
+    } \
+    throw std::bad_alloc(); \
+  } \
+  void operator delete(void* p, std::align_val_t) noexcept { \
+    std::free(p); \
+  } \
+  void operator delete(void* p, std::size_t, std::align_val_t) noexcept { \
+    std::free(p); \
+  }
+
+#else
+
+namespace reflstats {
+
+inline report snapshot() {
+  return {};
+}
+
+}  // namespace reflstats
+
+#define REFLSTATS_SCOPE(Type, Op, Size) static_cast<void>(0)
+#define REFLSTATS_COUNT_ALLOCATIONS()
+
+#endif
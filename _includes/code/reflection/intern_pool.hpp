@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace jk {
+namespace intern {
+
+static constexpr std::size_t default_capacity = 1 << 16;
+
+struct entry {
+  std::size_t hash;
+  std::string value;
+};
+
+// Handle to a string owned by a pool. Two handles from the same pool are equal
+// iff their strings are equal, so comparing and hashing them never touches the
+// characters.
+class interned_string {
+public:
+  interned_string() = default;
+  explicit interned_string(const entry* e) : entry_(e) {}
+
+  std::string_view view() const {
+    return entry_ ? std::string_view(entry_->value) : std::string_view();
+  }
+
+  // false for a default-constructed handle or a failed intern
+  bool valid() const {
+    return entry_ != nullptr;
+  }
+
+  const entry* get() const {
+    return entry_;
+  }
+
+  bool operator==(const interned_string& other) const {
+    return entry_ == other.entry_;
+  }
+
+  bool operator!=(const interned_string& other) const {
+    return entry_ != other.entry_;
+  }
+
+private:
+  const entry* entry_ = nullptr;
+};
+
+// Open-addressing tables chained into segments, each twice the size of the
+// one before. A slot only ever goes from null to an entry, so lookups and
+// inserts need no lock: an insert publishes its entry with a single
+// compare-exchange, and the loser of a race adopts the winner. A string goes
+// in the first segment where one of its probe slots is still null; once all
+// of them are taken they stay taken, so every thread looking for the string
+// walks the same segments and finds the same entry. Entries live as long as
+// the pool, so handed-out views stay valid.
+class pool {
+public:
+  static constexpr std::size_t unlimited = static_cast<std::size_t>(-1);
+
+  // capacity is the size of the first segment. Segments are added until the
+  // total would pass max_capacity.
+  explicit pool(std::size_t capacity = default_capacity, std::size_t max_capacity = unlimited)
+  : first_(round_up_power_of_two(capacity)), max_capacity_(max_capacity) {}
+
+  pool(const pool&) = delete;
+  pool& operator=(const pool&) = delete;
+
+  // Returns an invalid handle only if adding a segment would pass max_capacity
+  interned_string intern(std::string_view value) {
+    const std::size_t hash = std::hash<std::string_view>{}(value);
+    std::unique_ptr<entry> candidate;
+    std::size_t capacity = 0;
+    for (segment* s = &first_; s != nullptr; ) {
+      capacity += s->mask + 1;
+      const std::size_t n_probes = std::min(max_probes, s->mask + 1);
+      for (std::size_t probe = 0; probe < n_probes; ++probe) {
+        auto& slot = s->slots[(hash + probe) & s->mask];
+        entry* current = slot.load(std::memory_order_acquire);
+        if (current == nullptr) {
+          if (!candidate) {
+            candidate.reset(new entry{hash, std::string(value)});
+          }
+          if (slot.compare_exchange_strong(current, candidate.get(),
+                std::memory_order_acq_rel, std::memory_order_acquire)) {
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return interned_string(candidate.release());
+          }
+          // Lost the race; current now holds the entry that won
+        }
+        if (current->hash == hash && current->value == value) {
+          return interned_string(current);
+        }
+      }
+      s = next_segment(*s, capacity);
+    }
+    return interned_string();
+  }
+
+  std::size_t size() const {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  // Slots in all the segments allocated so far
+  std::size_t capacity() const {
+    std::size_t result = 0;
+    for (const segment* s = &first_; s != nullptr; s = s->next.load(std::memory_order_acquire)) {
+      result += s->mask + 1;
+    }
+    return result;
+  }
+
+private:
+  // Bounds the work per segment, so lookups stay short as segments fill
+  static constexpr std::size_t max_probes = 64;
+
+  struct segment {
+    explicit segment(std::size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<entry*>[capacity]) {
+      for (std::size_t i = 0; i <= mask; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    segment(const segment&) = delete;
+    segment& operator=(const segment&) = delete;
+
+    ~segment() {
+      for (std::size_t i = 0; i <= mask; ++i) {
+        delete slots[i].load(std::memory_order_relaxed);
+      }
+      delete next.load(std::memory_order_relaxed);
+    }
+
+    const std::size_t mask;
+    std::unique_ptr<std::atomic<entry*>[]> slots;
+    std::atomic<segment*> next{nullptr};
+  };
+
+  static std::size_t round_up_power_of_two(std::size_t n) {
+    std::size_t result = 1;
+    while (result < n) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  // The segment after s, added if there is none yet and it fits in
+  // max_capacity_. capacity counts the slots up to and including s.
+  segment* next_segment(segment& s, std::size_t capacity) {
+    segment* next = s.next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      return next;
+    }
+    const std::size_t grown = 2 * (s.mask + 1);
+    if (capacity > max_capacity_ || grown > max_capacity_ - capacity) {
+      return nullptr;
+    }
+    auto candidate = std::make_unique<segment>(grown);
+    if (s.next.compare_exchange_strong(next, candidate.get(),
+          std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return candidate.release();
+    }
+    // Another thread added it first
+    return next;
+  }
+
+  segment first_;
+  const std::size_t max_capacity_;
+  std::atomic<std::size_t> size_{0};
+};
+
+// Pool used by the reflser decoders for interned_string members. It grows
+// without limit, so a long-running process that decodes many distinct
+// strings keeps every one of them for its lifetime.
+inline pool& shared_pool() {
+  static pool instance;
+  return instance;
+}
+
+}  // namespace intern
+}  // namespace jk
+
+namespace std {
+
+template<>
+struct hash<jk::intern::interned_string> {
+  std::size_t operator()(const jk::intern::interned_string& s) const {
+    return std::hash<const jk::intern::entry*>{}(s.get());
+  }
+};
+
+}  // namespace std
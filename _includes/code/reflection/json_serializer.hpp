@@ -0,0 +1,533 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include "base64.hpp"
+#include "byte_buffer.hpp"
+#include "hot_cold.hpp"
+#include "instrumentation.hpp"
+#include "intern_pool.hpp"
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+#include "soa_vector.hpp"
+
+// JSON serialize and deserialize. Records are written and read member by
+// member through member_list, so the backend's refl_utilities.hpp has to
+// specialize it, and its reflenum.hpp has to be included first for enums.
+namespace reflser {
+
+namespace refl = jk::refl_utilities;
+namespace metap = jk::metaprogramming;
+
+enum struct scan_result {
+  continue_scanning,
+  stop_scanning,
+  error
+};
+
+// strip the surrounding whitespace
+// TODO: other characters besides ' '
+std::string_view strip_whitespace(const std::string_view& src) {
+  unsigned i1 = 0;
+  if (src[i1] == ' ') {
+    for (; i1 < src.size() - 1; i1++) {
+      if (src[i1] != ' ' || src[i1 + 1] != ' ') {
+        i1 += 1;
+        break;
+      }
+    }
+  }
+
+  unsigned i2 = src.size();
+  if (src[i2 - 1] == ' ') {
+    for (i2 = src.size() - 2; i2 > 0; i2--) {
+      if (src[i2] != ' ') {
+        i2 += 1;
+        break;
+      }
+    }
+  }
+
+  return src.substr(i1, i2 - i1);
+}
+
+// returns the substring 
+// needs to be able to propagate an error
+template<typename T>
+auto get_token_of_type(const std::string_view& src) {
+  unsigned count = 0;
+
+  auto condition = [](const std::string_view& str, unsigned i) {
+    if constexpr (std::is_floating_point<T>{}) {
+      char token = str[i];
+      if (token == '-') {
+        if (i != 0) {
+          return scan_result::error;
+        }
+      }
+
+      if (!std::isdigit(token) && token != '.') {
+        return scan_result::stop_scanning;
+      }
+      return scan_result::continue_scanning;
+
+    } else if constexpr (std::is_integral<T>{}) {
+      char token = str[i];
+      if (token == '-') {
+        if constexpr (!std::is_signed<T>{}) {
+          return scan_result::error;
+        } else if (i != 0) {
+          return scan_result::error;
+        }
+      }
+      if (!std::isdigit(token)) {
+        return scan_result::stop_scanning;
+      }
+      return scan_result::continue_scanning;
+    } else {
+      return scan_result::error;
+    }
+  };
+
+  scan_result result;
+  while ((result = condition(src, count++)) == scan_result::continue_scanning && count < src.size()) { }
+  if (result == scan_result::error) {
+    return std::string_view();
+  }
+
+  auto token = src.substr(0, count);
+
+  if constexpr (std::is_floating_point<T>{}) {
+    if (std::count(token.begin(), token.end(), '.') > 1) {
+      return std::string_view();
+    }
+  }
+  return token;
+}
+
+template<typename TokenT, typename T>
+auto scan_for_end_token(TokenT open, TokenT close, const T& src) {
+  // Scan src
+  unsigned token_depth = 0;
+  unsigned count = 0;
+  do {
+    if (src[count] == open) {
+      ++token_depth;
+    } else if (src[count] == close) {
+      if (token_depth > 0) {
+        --token_depth;
+      } else {
+        // we're done
+        return count;
+      }
+    }
+  } while (count++ < src.size());
+  // better error indication?
+  return count;
+}
+
+// Assumes that the first open token is already passed
+template<typename TokenT, typename T>
+auto count_outer_element_until_end(TokenT token,
+    const std::string_view& open_tokens, const std::string_view& close_tokens,
+    const T& src) {
+  unsigned token_depth = 0;
+  unsigned count = 0;
+  unsigned token_count = 0;
+  do {
+    if (src[count] == token && token_depth == 0) {
+      ++token_count;
+    } else if (open_tokens.find(src[count]) != std::string::npos) {
+      ++token_depth;
+    } else if (close_tokens.find(src[count]) != std::string::npos) {
+      if (token_depth > 0) {
+        --token_depth;
+      } else {
+        return token_count;
+      }
+    }
+  } while (count++ < src.size());
+  // may want to indicate an error here
+  return token_count;
+}
+
+template<typename TokenT, typename T>
+auto scan_outer_element_until(TokenT token,
+    const std::string_view& open_tokens, const std::string_view& close_tokens,
+    const T& src) {
+  // scan until token found
+  unsigned token_depth = 0;
+  unsigned count = 0;
+  do {
+    if (src[count] == token && token_depth == 0) {
+      return src.substr(0, count);
+    } else if (open_tokens.find(src[count]) != std::string::npos) {
+      ++token_depth;
+    } else if (close_tokens.find(src[count]) != std::string::npos) {
+      if (token_depth > 0) {
+        --token_depth;
+      } else {
+        return src.substr(0, count);
+      }
+    }
+  } while (count++ < src.size());
+
+  // better error indication?
+  return std::string_view();
+}
+
+enum struct serialize_result {
+  success,
+  unknown_type
+};
+
+std::string serialize_result_message(serialize_result result) {
+  switch(result) {
+    case serialize_result::success:
+      return "Success";
+    case serialize_result::unknown_type:
+      return "Don't know how to serialize to output type";
+  }
+}
+
+// generic json serialization
+template<typename T>
+auto serialize(const T& src, std::string& dst) {
+  REFLSTATS_SCOPE(T, serialize, dst.size());
+  if constexpr (std::is_same<T, std::string>{}) {
+    dst += "\"" + src + "\"";
+    return serialize_result::success;
+  } else if constexpr (std::is_same<T, bool>{}) {
+    dst += src ? "true" : "false";
+    return serialize_result::success;
+  } else if constexpr (std::is_enum<T>{}) {
+    // Named enumerators are written as strings, anything else as the underlying value
+    if (auto name = reflenum::to_string(src); !name.empty()) {
+      dst += "\"";
+      dst += name;
+      dst += "\"";
+    } else {
+      dst += std::to_string(static_cast<std::underlying_type_t<T>>(src));
+    }
+    return serialize_result::success;
+  } else if constexpr (metap::is_detected<metap::stringable, T>{}) {
+    dst += std::to_string(src);
+    return serialize_result::success;
+  } else if constexpr (refl::is_byte_buffer<T>{}) {
+    // One base64 string, written straight into dst between the quotes
+    const std::size_t offset = dst.size() + 1;
+    dst.resize(offset + jk::base64::encoded_size(src.size()) + 1, '"');
+    jk::base64::encode(src.data(), src.size(), &dst[offset]);
+    return serialize_result::success;
+  } else if constexpr (metap::is_detected<metap::iterable, T>{}) {
+    // This structure has an array-like layout.
+    dst += "[ ";
+    for (auto it = src.begin(); it != src.end(); ++it) {
+      auto entry = *it;
+      auto result = serialize(entry, dst);
+      if (result != serialize_result::success) {
+        return result;
+      }
+      if (it != (src.end() - 1)) {
+        dst += ", ";
+      }
+    }
+    dst += " ]";
+    return serialize_result::success;
+  } else if constexpr (std::is_same<T, jk::intern::interned_string>{}) {
+    dst += "\"";
+    dst += src.view();
+    dst += "\"";
+    return serialize_result::success;
+  } else if constexpr (refl::is_hot_cold<T>{}) {
+    return serialize(src.record(), dst);
+  } else if constexpr (refl::is_record<T>{}) {
+    dst += "{ ";
+
+    serialize_result result = serialize_result::success;
+
+    refl::all_members<T>([&src, &dst, &result](const auto& member) {
+      using info = std::decay_t<decltype(member)>;
+      dst += "\"";
+      dst += member.name;
+      dst += "\" : ";
+      if (result = serialize(src.*info::pointer, dst);
+          result != serialize_result::success) {
+        return false;
+      }
+      dst += ", ";
+      return true;
+    });
+    // take off the last character
+    if (result == serialize_result::success) {
+      dst.replace(dst.size() - 2, 2, " }");
+    }
+    return result;
+  }
+  return serialize_result::unknown_type;
+}
+
+// generic json deserialization
+enum struct deserialize_result {
+  success,
+  empty_input,
+  malformed_input,
+  mismatched_token,
+  mismatched_type,
+  intern_pool_full,
+  unknown_type
+};
+
+std::string deserialize_result_message(deserialize_result result) {
+  switch(result) {
+    case deserialize_result::success:
+      return "Success";
+    case deserialize_result::empty_input:
+      return "Input string to deserialize was empty";
+    case deserialize_result::malformed_input:
+      return "Input string to deserialize was malformed";
+    case deserialize_result::mismatched_token:
+      return "A token was mismatched (e.g. missing open or close brace)";
+    case deserialize_result::mismatched_type:
+      return "Type of output didn't match input schema (e.g. wrong number of fields)";
+    case deserialize_result::intern_pool_full:
+      return "String intern pool has no free slots";
+    case deserialize_result::unknown_type:
+      return "Don't know how to deserialize to output type";
+  }
+}
+
+// On success src is advanced past the value that was read
+template<typename T>
+auto deserialize(std::string_view& src, T& dst) {
+  REFLSTATS_SCOPE(T, deserialize, src.size());
+  if (src.empty()) {
+    return deserialize_result::empty_input;
+  }
+  if constexpr (std::is_same<T, std::string>{}) {
+    // Scan until the first quote
+    auto quote_index = std::find(src.begin(), src.end(), '"');
+
+    if (quote_index == src.end()) {
+      return deserialize_result::malformed_input;
+    }
+    src.remove_prefix(quote_index - src.begin() + 1);
+
+    if (auto it = std::find(src.begin(), src.end(), '"'); it != src.end()) {
+      auto index = it - src.begin();
+      dst = src.substr(0, index);
+      src.remove_prefix(index + 1);
+      return deserialize_result::success;
+    }
+    return deserialize_result::malformed_input;
+  } else if constexpr (std::is_same<T, bool>{}) {
+    auto stripped = strip_whitespace(src);
+    if (stripped.substr(0, 4) == "true") {
+      dst = true;
+      src.remove_prefix(stripped.data() - src.data() + 4);
+      return deserialize_result::success;
+    } else if (stripped.substr(0, 5) == "false") {
+      dst = false;
+      src.remove_prefix(stripped.data() - src.data() + 5);
+      return deserialize_result::success;
+    }
+    return deserialize_result::malformed_input;
+  } else if constexpr (std::is_arithmetic<T>{}) {
+    auto token = get_token_of_type<T>(strip_whitespace(src));
+    auto token_count = token.size();
+    if (token_count == 0) {
+      return deserialize_result::malformed_input;
+    }
+
+    dst = boost::lexical_cast<T>(token);
+    src.remove_prefix(token.data() - src.data() + token_count);
+    return deserialize_result::success;
+  } else if constexpr (std::is_enum<T>{}) {
+    auto stripped = strip_whitespace(src);
+    if (stripped[0] == '"') {
+      stripped.remove_prefix(1);
+      auto quote_index = stripped.find('"');
+      if (quote_index == std::string_view::npos) {
+        return deserialize_result::malformed_input;
+      }
+      if (!reflenum::from_string(stripped.substr(0, quote_index), dst)) {
+        return deserialize_result::mismatched_type;
+      }
+      src.remove_prefix(stripped.data() - src.data() + quote_index + 1);
+      return deserialize_result::success;
+    }
+
+    using underlying_t = std::underlying_type_t<T>;
+    auto token = get_token_of_type<underlying_t>(stripped);
+    if (token.size() == 0) {
+      return deserialize_result::malformed_input;
+    }
+    dst = static_cast<T>(boost::lexical_cast<underlying_t>(token));
+    src.remove_prefix(token.data() - src.data() + token.size());
+    return deserialize_result::success;
+  } else if constexpr (std::is_same<T, jk::intern::interned_string>{}) {
+    // Same token rules as std::string, but repeated values share one allocation
+    auto quote_index = std::find(src.begin(), src.end(), '"');
+    if (quote_index == src.end()) {
+      return deserialize_result::malformed_input;
+    }
+    src.remove_prefix(quote_index - src.begin() + 1);
+
+    if (auto it = std::find(src.begin(), src.end(), '"'); it != src.end()) {
+      dst = jk::intern::shared_pool().intern(src.substr(0, it - src.begin()));
+      if (!dst.valid()) {
+        return deserialize_result::intern_pool_full;
+      }
+      src.remove_prefix(it - src.begin() + 1);
+      return deserialize_result::success;
+    }
+    return deserialize_result::malformed_input;
+  } else if constexpr (refl::is_hot_cold<T>{}) {
+    typename T::value_type record;
+    if (auto result = deserialize(src, record); result != deserialize_result::success) {
+      return result;
+    }
+    dst = record;
+    return deserialize_result::success;
+  } else if constexpr (refl::is_byte_buffer<T>{}) {
+    // Sized from the base64 length and decoded in place
+    auto quote_index = std::find(src.begin(), src.end(), '"');
+    if (quote_index == src.end()) {
+      return deserialize_result::malformed_input;
+    }
+    src.remove_prefix(quote_index - src.begin() + 1);
+
+    auto encoded = src.substr(0, src.find('"'));
+    if (encoded.size() == src.size()) {
+      return deserialize_result::malformed_input;
+    }
+    const std::size_t size = jk::base64::decoded_size(encoded);
+    if (size == jk::base64::npos) {
+      return deserialize_result::malformed_input;
+    }
+    if constexpr (metap::is_detected<metap::resizable, T>{}) {
+      dst.resize(size);
+    } else if (dst.size() != size) {
+      return deserialize_result::mismatched_type;
+    }
+    if (!jk::base64::decode(encoded, dst.data())) {
+      return deserialize_result::malformed_input;
+    }
+    src.remove_prefix(encoded.size() + 1);
+    return deserialize_result::success;
+  } else if constexpr (refl::is_soa_vector<T>{}) {
+    // Decoded as a std::vector of records, then moved into the columns
+    std::vector<typename T::value_type> records;
+    if (auto result = deserialize(src, records); result != deserialize_result::success) {
+      return result;
+    }
+    dst.clear();
+    dst.append(std::make_move_iterator(records.begin()), std::make_move_iterator(records.end()));
+    return deserialize_result::success;
+  } else if constexpr (metap::is_detected<metap::iterable, T>{}) {
+    auto stripped = strip_whitespace(src);
+    if (stripped[0] != '[') {
+      return deserialize_result::malformed_input;
+    }
+    stripped.remove_prefix(1);
+    auto array_end = scan_for_end_token('[', ']', stripped);
+    if (array_end <= 1) {
+      return deserialize_result::mismatched_token;
+    }
+
+    auto array_token = stripped.substr(0, array_end);
+
+    auto n_elements = count_outer_element_until_end(',', "[{", "]}", array_token) + 1;
+
+    if constexpr (metap::is_detected<metap::resizable, T>{}) {
+      dst.resize(n_elements);
+      // TODO case where the container has dynamic size and is not default-constructible
+    } else if constexpr (metap::is_detected<metap::has_tuple_size, T>{}) {
+      if (std::tuple_size<T>{} != n_elements) {
+        return deserialize_result::mismatched_type;
+      }
+    }
+    assert(n_elements == dst.size());
+
+    for (unsigned index = 0; index < n_elements; index++) {
+      auto token = scan_outer_element_until(',', "[{", "]}", array_token);
+      array_token.remove_prefix(token.size());
+      if (auto result = deserialize(token, dst[index]); result != deserialize_result::success) {
+        return result;
+      }
+      if (array_token[0] == ',') {
+        array_token.remove_prefix(1);
+      }
+    }
+
+    // Past the closing bracket
+    src.remove_prefix(std::min<std::size_t>(stripped.data() - src.data() + array_end + 1,
+      src.size()));
+    return deserialize_result::success;
+  } else if constexpr (refl::is_record<T>{}) {
+    auto stripped = strip_whitespace(src);
+    if (stripped[0] != '{') {
+      return deserialize_result::malformed_input;
+    }
+    auto object_end = scan_for_end_token('{', '}', stripped);
+    if (object_end == stripped.size()) {
+      return deserialize_result::mismatched_token;
+    }
+    auto object_token = stripped.substr(1, object_end);
+
+    auto n_colons = count_outer_element_until_end(':', "{[", "}]", object_token);
+    auto n_commas = count_outer_element_until_end(',', "{[", "}]", object_token);
+
+    if (n_colons != n_commas + 1) {
+      return deserialize_result::malformed_input;
+    }
+
+    if (n_colons != refl::n_members<T>) {
+      return deserialize_result::mismatched_type;
+    }
+
+    deserialize_result result = deserialize_result::success;
+    for (unsigned i = 0; i < n_colons; ++i) {
+      auto key_index = std::find(object_token.begin(), object_token.end(), ':') - object_token.begin();
+
+      auto quote_index = std::find(object_token.begin(), object_token.begin() + key_index, '"') - object_token.begin();
+      object_token.remove_prefix(quote_index + 1);
+      quote_index = std::find(object_token.begin(), object_token.begin() + key_index, '"') - object_token.begin();
+
+      const auto key = object_token.substr(0, quote_index);
+      key_index = std::find(object_token.begin(), object_token.end(), ':') - object_token.begin();
+      object_token.remove_prefix(key_index + 1);
+
+      auto value_token = scan_outer_element_until(',', "{[", "}]", object_token);
+      auto value_index = value_token.size();
+      object_token.remove_prefix(value_index);
+
+      refl::all_members<T>([&dst, &key, &value_token, &result](const auto& member) {
+        using info = std::decay_t<decltype(member)>;
+        if (key != member.name) {
+          return true;
+        }
+        result = deserialize(value_token, dst.*info::pointer);
+        return false;
+      });
+      if (result != deserialize_result::success) {
+        return result;
+      }
+    }
+    // What is left of the object starts at its closing brace
+    auto close_index = object_token.find('}');
+    src.remove_prefix(object_token.data() - src.data() +
+      (close_index == std::string_view::npos ? object_token.size() : close_index + 1));
+    return deserialize_result::success;
+  }
+  return deserialize_result::unknown_type;
+}
+
+}  // namespace reflser
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "member_layout.hpp"
+
+namespace refllayout {
+
+namespace refl = jk::refl_utilities;
+
+struct member_report {
+  refl::member_layout layout;
+  // Unused bytes between the end of the previous member and this one
+  std::size_t padding_before;
+  // The member spans two cache lines of an object that starts on one
+  bool straddles_cache_line;
+};
+
+struct layout_report {
+  std::size_t size;
+  std::size_t align;
+  // In offset order
+  std::vector<member_report> members;
+  // Bytes not covered by any member, tail padding included
+  std::size_t padding;
+  std::size_t tail_padding;
+  std::size_t straddling_members;
+  std::size_t cache_lines;
+  // Declaration order stably sorted by decreasing alignment, which leaves
+  // only the padding that alignment forces
+  std::vector<std::string_view> suggested_order;
+  std::size_t suggested_size;
+};
+
+constexpr std::size_t round_up(std::size_t n, std::size_t align) {
+  return (n + align - 1) / align * align;
+}
+
+inline layout_report analyze_layout(std::vector<refl::member_layout> members,
+    std::size_t size, std::size_t align, std::size_t cache_line = 64) {
+  layout_report report = {};
+  report.size = size;
+  report.align = align;
+  report.cache_lines = (size + cache_line - 1) / cache_line;
+
+  auto by_alignment = members;
+  std::stable_sort(by_alignment.begin(), by_alignment.end(),
+    [](const refl::member_layout& a, const refl::member_layout& b) {
+      return a.align > b.align;
+    });
+  std::size_t end = 0;
+  for (const auto& member : by_alignment) {
+    report.suggested_order.push_back(member.name);
+    end = round_up(end, member.align) + member.size;
+  }
+  report.suggested_size = std::max<std::size_t>(round_up(end, align), 1);
+
+  std::stable_sort(members.begin(), members.end(),
+    [](const refl::member_layout& a, const refl::member_layout& b) {
+      return a.offset < b.offset;
+    });
+  end = 0;
+  for (const auto& member : members) {
+    const std::size_t padding = member.offset > end ? member.offset - end : 0;
+    const bool straddles = member.size > 0 &&
+      member.offset / cache_line != (member.offset + member.size - 1) / cache_line;
+    report.members.push_back(member_report{member, padding, straddles});
+    report.padding += padding;
+    report.straddling_members += straddles;
+    end = std::max(end, member.offset + member.size);
+  }
+  report.tail_padding = size > end ? size - end : 0;
+  report.padding += report.tail_padding;
+  return report;
+}
+
+// Layout of T from its reflected members
+template<typename T>
+layout_report analyze(std::size_t cache_line = 64) {
+  return analyze_layout(refl::member_layouts<T>(), sizeof(T), alignof(T), cache_line);
+}
+
+// A table for humans, e.g. in a tool that checks the largest record types:
+//
+// request: 40 bytes, align 8, 20 bytes padding, 1 cache line
+//   offset  size  align  member
+//        0     1      1  flag (bool)
+//        8     8      8  id (uint64_t)  [7 bytes padding before]
+//   ...
+//   6 bytes tail padding
+//   suggested order: id, latency, s, flag, c (24 bytes)
+inline std::string format_report(std::string_view type_name, const layout_report& report) {
+  auto pad = [](std::string s, std::size_t width) {
+    return std::string(width > s.size() ? width - s.size() : 0, ' ') + s;
+  };
+
+  std::string out;
+  out += type_name;
+  out += ": " + std::to_string(report.size) + " bytes, align " + std::to_string(report.align) +
+    ", " + std::to_string(report.padding) + " bytes padding, " +
+    std::to_string(report.cache_lines) + (report.cache_lines == 1 ? " cache line\n" : " cache lines\n");
+  out += "  offset  size  align  member\n";
+  for (const auto& member : report.members) {
+    out += "  " + pad(std::to_string(member.layout.offset), 6) +
+      pad(std::to_string(member.layout.size), 6) + pad(std::to_string(member.layout.align), 7) + "  ";
+    out += member.layout.name;
+    out += " (";
+    out += member.layout.type;
+    out += ")";
+    if (member.padding_before > 0) {
+      out += "  [" + std::to_string(member.padding_before) + " bytes padding before]";
+    }
+    if (member.straddles_cache_line) {
+      out += "  [straddles a cache line]";
+    }
+    out += "\n";
+  }
+  if (report.tail_padding > 0) {
+    out += "  " + std::to_string(report.tail_padding) + " bytes tail padding\n";
+  }
+  if (report.suggested_size < report.size) {
+    out += "  suggested order:";
+    for (std::size_t i = 0; i < report.suggested_order.size(); ++i) {
+      out += i == 0 ? " " : ", ";
+      out += report.suggested_order[i];
+    }
+    out += " (" + std::to_string(report.suggested_size) + " bytes)\n";
+  }
+  return out;
+}
+
+}  // namespace refllayout
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jk {
+namespace mapped_file {
+
+// Read-only view of a whole file. Pages are faulted in on first access, so
+// only the parts of the file that are read cost anything.
+class mapped_file {
+public:
+  mapped_file() = default;
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  mapped_file(mapped_file&& other)
+  : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+  mapped_file& operator=(mapped_file&& other) {
+    if (this != &other) {
+      close();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  ~mapped_file() {
+    close();
+  }
+
+  bool open(const char* path) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      close();
+      return false;
+    }
+    const bool mapped = map(fd);
+    // The mapping keeps the file contents alive on its own
+    ::close(fd);
+    return mapped;
+  }
+
+  // Maps the whole of a file that is already open. fd stays with the caller.
+  bool map(int fd) {
+    close();
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      return false;
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+      void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        size_ = 0;
+        return false;
+      }
+      data_ = static_cast<const char*>(data);
+    }
+    return true;
+  }
+
+  void close() {
+    if (data_) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  std::string_view view() const {
+    return std::string_view(data_, size_);
+  }
+
+private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace mapped_file
+}  // namespace jk
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "perfect_hash.hpp"
+
+namespace reflaccess {
+
+// Coarse kind of a member's type, for callers that dispatch on it
+enum struct type_tag {
+  boolean,
+  signed_integer,
+  unsigned_integer,
+  floating_point,
+  string,
+  enumeration,
+  other
+};
+
+template<typename T>
+constexpr type_tag type_tag_of() {
+  if constexpr (std::is_same<T, bool>{}) {
+    return type_tag::boolean;
+  } else if constexpr (std::is_integral<T>{}) {
+    return std::is_signed<T>{} ? type_tag::signed_integer : type_tag::unsigned_integer;
+  } else if constexpr (std::is_floating_point<T>{}) {
+    return type_tag::floating_point;
+  } else if constexpr (std::is_same<T, std::string>{} || std::is_same<T, std::string_view>{}) {
+    return type_tag::string;
+  } else if constexpr (std::is_enum<T>{}) {
+    return type_tag::enumeration;
+  } else {
+    return type_tag::other;
+  }
+}
+
+// The address of type_id<T> identifies T exactly, in constant expressions too
+template<typename T>
+inline constexpr char type_id = 0;
+
+// Everything needed to reach one member of T given only its name at runtime.
+// get and set go through reflser's JSON representation of the member.
+template<typename T>
+struct member_descriptor {
+  std::string_view name;
+  type_tag tag;
+  const void* type;
+  void* (*address)(T&);
+  bool (*get)(const T&, std::string&);
+  bool (*set)(T&, std::string_view);
+};
+
+template<typename T, std::size_t N>
+struct descriptor_table {
+  std::array<member_descriptor<T>, N> members;
+  jk::perfect_hash::table<N> index;
+
+  // One hash probe; null for an unknown name
+  constexpr const member_descriptor<T>* find(std::string_view name) const {
+    const auto i = index.find(name);
+    return i == N ? nullptr : &members[i];
+  }
+};
+
+template<typename T, std::size_t N>
+constexpr descriptor_table<T, N> make_descriptor_table(
+    const std::array<member_descriptor<T>, N>& members) {
+  std::array<std::string_view, N> names = {};
+  for (std::size_t i = 0; i < N; ++i) {
+    names[i] = members[i].name;
+  }
+  return descriptor_table<T, N>{members, jk::perfect_hash::make_table(names)};
+}
+
+enum struct access_result {
+  success,
+  unknown_member,
+  conversion_failed
+};
+
+inline std::string access_result_message(access_result result) {
+  switch (result) {
+    case access_result::success:
+      return "Success";
+    case access_result::unknown_member:
+      return "Type has no member with the given name";
+    case access_result::conversion_failed:
+      return "Member value could not be converted";
+  }
+  return "";
+}
+
+// Typed access: null unless the member exists and has exactly type M
+template<typename M, typename T, std::size_t N>
+M* member_if(const descriptor_table<T, N>& table, T& object, std::string_view name) {
+  const auto* member = table.find(name);
+  if (!member || member->type != &type_id<M>) {
+    return nullptr;
+  }
+  return static_cast<M*>(member->address(object));
+}
+
+template<typename T, std::size_t N>
+access_result get_json(const descriptor_table<T, N>& table, const T& object,
+    std::string_view name, std::string& dst) {
+  const auto* member = table.find(name);
+  if (!member) {
+    return access_result::unknown_member;
+  }
+  return member->get(object, dst) ? access_result::success : access_result::conversion_failed;
+}
+
+template<typename T, std::size_t N>
+access_result set_json(const descriptor_table<T, N>& table, T& object,
+    std::string_view name, std::string_view src) {
+  const auto* member = table.find(name);
+  if (!member) {
+    return access_result::unknown_member;
+  }
+  return member->set(object, src) ? access_result::success : access_result::conversion_failed;
+}
+
+}  // namespace reflaccess
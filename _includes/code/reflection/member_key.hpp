@@ -0,0 +1,36 @@
+#pragma once
+
+#include <type_traits>
+
+#include "soa_vector.hpp"
+
+namespace jk {
+namespace refl_utilities {
+
+// Pointer to the data member of T named Str. Defined by the backend's
+// refl_utilities.hpp.
+template<typename T, auto Str>
+constexpr auto get_member_pointer();
+
+// Key is either a data member pointer or the name of a data member of T, as
+// a pointer to a static string:
+//
+// static constexpr char latency[] = "latency";
+// member_of<request, latency>() == member_of<request, &request::latency>()
+template<typename T, auto Key>
+constexpr auto member_of() {
+  if constexpr (std::is_member_object_pointer<decltype(Key)>{}) {
+    return Key;
+  } else {
+    return get_member_pointer<T, Key>();
+  }
+}
+
+// The type of the member that Member points to. decltype of a deduced
+// template argument can keep the const or reference of the expression it was
+// deduced from, so it's decayed.
+template<auto Member>
+using member_type_t = typename member_pointer_traits<std::decay_t<decltype(Member)>>::member_type;
+
+}  // namespace refl_utilities
+}  // namespace jk
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace jk {
+namespace refl_utilities {
+
+struct member_layout {
+  std::string_view name;
+  std::string_view type;
+  std::size_t offset;
+  std::size_t size;
+  std::size_t align;
+};
+
+// The data members of T in declaration order. Defined in member_list.hpp.
+template<typename T>
+std::vector<member_layout> member_layouts();
+
+// Offsets of members aren't constant expressions, and offsetof needs the
+// member's identifier, so they're measured on a value-initialized T that is
+// kept for the rest of the program. The offsets are those of a complete T;
+// only standard-layout types are guaranteed to have the same ones as
+// offsetof would give.
+template<typename T, typename M>
+std::size_t member_offset(M T::* member) {
+  static_assert(std::is_default_constructible<T>{},
+    "Member offsets are measured on a value-initialized T.");
+  static const T object{};
+  return static_cast<std::size_t>(
+    reinterpret_cast<const unsigned char*>(std::addressof(object.*member)) -
+    reinterpret_cast<const unsigned char*>(std::addressof(object)));
+}
+
+}  // namespace refl_utilities
+}  // namespace jk
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "member_key.hpp"
+#include "member_layout.hpp"
+#include "soa_vector.hpp"
+
+namespace jk {
+namespace refl_utilities {
+
+// One data member of a reflected type. The pointer and type are known at
+// compile time from the type of the descriptor, so generic code gets the
+// same thing from either backend:
+//
+// for_each_member<T>([&value](const auto& member) {
+//   using M = std::decay_t<decltype(member)>;
+//   visit(member.name, value.*M::pointer);
+// });
+template<auto Pointer>
+struct member_info {
+  static constexpr auto pointer = Pointer;
+  using type = member_type_t<Pointer>;
+  using class_type =
+    typename member_pointer_traits<std::decay_t<decltype(Pointer)>>::class_type;
+
+  std::string_view name;
+  std::string_view type_name;
+};
+
+// The data members of T in declaration order, as a std::tuple of
+// member_info in `value`. The backend's refl_utilities.hpp specializes it for
+// every type with reflectable data members.
+template<typename T, typename = void>
+struct member_list {};
+
+template<typename T, typename = void>
+struct is_record : std::false_type {};
+
+template<typename T>
+struct is_record<T, std::void_t<decltype(member_list<T>::value)>> : std::true_type {};
+
+template<typename T>
+inline constexpr std::size_t n_members =
+  std::tuple_size<std::decay_t<decltype(member_list<T>::value)>>{};
+
+template<typename T, std::size_t I>
+using member_info_t = std::decay_t<decltype(std::get<I>(member_list<T>::value))>;
+
+template<typename T, typename F>
+constexpr void for_each_member(F&& f) {
+  std::apply([&f](const auto& ...member) {
+    static_cast<void>((f(member), ...));
+  }, member_list<T>::value);
+}
+
+// Stops at the first member for which f returns false
+template<typename T, typename F>
+constexpr bool all_members(F&& f) {
+  return std::apply([&f](const auto& ...member) {
+    return (static_cast<bool>(f(member)) && ...);
+  }, member_list<T>::value);
+}
+
+template<auto ...Pointer>
+constexpr auto pointers_of(const std::tuple<member_info<Pointer>...>&) {
+  return std::make_tuple(Pointer...);
+}
+
+template<typename T>
+struct member_pointers {
+  static constexpr auto value = pointers_of(member_list<T>::value);
+};
+
+template<typename T>
+std::vector<member_layout> member_layouts() {
+  return std::apply([](const auto& ...member) {
+    return std::vector<member_layout>{member_layout{
+      member.name,
+      member.type_name,
+      member_offset(member.pointer),
+      sizeof(typename std::decay_t<decltype(member)>::type),
+      alignof(typename std::decay_t<decltype(member)>::type)
+    }...};
+  }, member_list<T>::value);
+}
+
+}  // namespace refl_utilities
+}  // namespace jk
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace jk {
+namespace refl_utilities {
+
+// Names sorted once at compile time, each with its position in declaration
+// order. A lookup is a binary search in a constant expression instead of one
+// template instantiation per candidate name.
+template<std::size_t N>
+struct name_index {
+  static constexpr std::size_t npos = N;
+
+  std::array<std::string_view, N> names = {};
+  std::array<std::size_t, N> indices = {};
+
+  constexpr std::size_t find(std::string_view name) const {
+    std::size_t first = 0;
+    std::size_t last = N;
+    while (first < last) {
+      const std::size_t mid = first + (last - first) / 2;
+      if (names[mid] < name) {
+        first = mid + 1;
+      } else {
+        last = mid;
+      }
+    }
+    return first < N && names[first] == name ? indices[first] : npos;
+  }
+
+  constexpr bool contains(std::string_view name) const {
+    return find(name) != npos;
+  }
+};
+
+// Bottom-up merge sort, so building the index stays O(N log N) comparisons
+template<std::size_t N>
+constexpr name_index<N> make_name_index(const std::array<std::string_view, N>& names) {
+  name_index<N> result;
+  name_index<N> buffer;
+  for (std::size_t i = 0; i < N; ++i) {
+    result.names[i] = names[i];
+    result.indices[i] = i;
+  }
+  for (std::size_t width = 1; width < N; width *= 2) {
+    for (std::size_t first = 0; first < N; first += 2 * width) {
+      const std::size_t mid = first + width < N ? first + width : N;
+      const std::size_t last = first + 2 * width < N ? first + 2 * width : N;
+      std::size_t a = first;
+      std::size_t b = mid;
+      for (std::size_t k = first; k < last; ++k) {
+        const bool take_a = a < mid && (b == last || !(result.names[b] < result.names[a]));
+        const std::size_t from = take_a ? a++ : b++;
+        buffer.names[k] = result.names[from];
+        buffer.indices[k] = result.indices[from];
+      }
+    }
+    result = buffer;
+  }
+  return result;
+}
+
+}  // namespace refl_utilities
+}  // namespace jk
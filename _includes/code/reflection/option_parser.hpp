@@ -0,0 +1,260 @@
+#pragma once
+
+#include <boost/hana/string.hpp>
+
+#include <experimental/optional>
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "config_sources.hpp"
+#include "instrumentation.hpp"
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+#include "option_reload.hpp"
+#include "option_table.hpp"
+#include "option_values.hpp"
+#include "perfect_hash.hpp"
+
+#include <vrm/pp/arg_count.hpp>
+#include <vrm/pp/cat.hpp>
+
+// Options structs declared with REFLOPT_OPTION, parsed from argv, config
+// files and the environment. The members are found through member_list, so
+// the backend's refl_utilities.hpp has to specialize it, and reflser.hpp
+// has to come first for JSON config files.
+namespace reflopt {
+  namespace refl = jk::refl_utilities;
+  namespace metap = jk::metaprogramming;
+  namespace hana = boost::hana;
+
+  template<typename T>
+  using optional_t = std::experimental::optional<T>;
+
+  template<typename Id, typename Flag, typename ShortFlag, typename Help>
+  struct Option
+  {
+    static constexpr Id identifier;
+    static constexpr Flag flag;
+    static constexpr ShortFlag short_flag;
+    static constexpr Help help;
+  };
+
+  template<typename OptionsStruct>
+  struct OptionsMap {
+    template<std::size_t I>
+    using member_t = std::decay_t<typename refl::member_info_t<OptionsStruct, I>::type>;
+
+    template<typename Indices>
+    struct unpack_members;
+    template<std::size_t... I>
+    struct unpack_members<std::index_sequence<I...>> {
+      static constexpr std::array<bool, sizeof...(I)> is_option{{
+        metap::is_specialization<member_t<I>, Option>{}...
+      }};
+    };
+    using members = unpack_members<std::make_index_sequence<refl::n_members<OptionsStruct>>>;
+
+    // Member indices of the Option tags. REFLOPT_OPTION declares every tag
+    // directly before the member it describes, so no name lookup is needed.
+    static constexpr auto option_indices = table::indices_of<
+      table::count(members::is_option)>(members::is_option);
+    static constexpr std::size_t n_options = option_indices.size();
+    static_assert(n_options > 0,
+        "No options found. Did you define options with the REFLOPT_OPTION macro?");
+
+    template<std::size_t K>
+    using option_t = member_t<option_indices[K]>;
+
+    template<std::size_t K>
+    static bool assign_value(OptionsStruct& options, std::string_view value) {
+      constexpr auto member_pointer =
+        refl::member_info_t<OptionsStruct, option_indices[K] + 1>::pointer;
+      return values::parse_value(value, options.*member_pointer);
+    }
+
+    template<std::size_t K>
+    static bool assign_json(OptionsStruct& options, std::string_view value) {
+      constexpr auto member_pointer =
+        refl::member_info_t<OptionsStruct, option_indices[K] + 1>::pointer;
+      return reflser::deserialize(value, options.*member_pointer)
+        == reflser::deserialize_result::success;
+    }
+
+    using setter_t = bool (*)(OptionsStruct&, std::string_view);
+
+    // Per-option strings and setters, all indexed by option
+    template<typename Indices>
+    struct option_arrays;
+    template<std::size_t... K>
+    struct option_arrays<std::index_sequence<K...>> {
+      static constexpr std::array<std::string_view, n_options> identifiers{{
+        hana::to<const char*>(option_t<K>::identifier)...
+      }};
+      static constexpr std::array<std::string_view, n_options> long_flags{{
+        hana::to<const char*>(option_t<K>::flag)...
+      }};
+      static constexpr std::array<std::string_view, n_options> short_flags{{
+        hana::to<const char*>(option_t<K>::short_flag)...
+      }};
+      static constexpr std::array<setter_t, n_options> setters{{&assign_value<K>...}};
+      static constexpr std::array<setter_t, n_options> json_setters{{&assign_json<K>...}};
+    };
+    using arrays = option_arrays<std::make_index_sequence<n_options>>;
+
+    static constexpr auto flags = table::collect_flags<
+      table::count_flags(arrays::short_flags)>(arrays::long_flags, arrays::short_flags);
+    static constexpr auto flag_table = jk::perfect_hash::make_table(flags.names);
+    static_assert(flag_table.valid, "Two options share the same flag.");
+
+    static constexpr auto identifier_table = jk::perfect_hash::make_table(arrays::identifiers);
+    static_assert(identifier_table.valid, "No perfect hash found for the option identifiers.");
+
+    // Resolves the flag with one hash and one string comparison, then calls
+    // the member's setter directly. Returns false for an unknown flag or a
+    // value that doesn't convert.
+    static bool try_set(OptionsStruct& options, std::string_view flag, std::string_view value) {
+      const auto index = flag_table.find(flag);
+      return index != flags.names.size() && arrays::setters[flags.owners[index]](options, value);
+    }
+
+    // Same, keyed by option identifier as written in config files and
+    // environment variables
+    static bool set_identifier(OptionsStruct& options, std::string_view id,
+        std::string_view value) {
+      const auto index = identifier_table.find(id);
+      return index != n_options && arrays::setters[index](options, value);
+    }
+
+    static bool set_identifier_json(OptionsStruct& options, std::string_view id,
+        std::string_view value) {
+      const auto index = identifier_table.find(id);
+      return index != n_options && arrays::json_setters[index](options, value);
+    }
+
+    // Index of the option with identifier id, or n_options if there is none.
+    // ignore_case is for environment variables, which are usually upper
+    // case; an exact match still wins over one that only differs in case.
+    static std::size_t find_identifier(std::string_view id, bool ignore_case = false) {
+      const auto index = identifier_table.find(id);
+      if (index != n_options || !ignore_case) {
+        return index;
+      }
+      for (std::size_t i = 0; i < n_options; ++i) {
+        if (config::equal_ignoring_case(arrays::identifiers[i], id)) {
+          return i;
+        }
+      }
+      return n_options;
+    }
+
+    static bool set_option(OptionsStruct& options, std::size_t index, std::string_view value) {
+      return arrays::setters[index](options, value);
+    }
+  };
+
+  // ArgVT boilerplate is to enable both char** and const char*[]'s for testing
+  template<typename OptionsStruct, typename ArgVT,
+    typename std::enable_if_t<
+      std::is_same<ArgVT, char**>{} || std::is_same<ArgVT, const char**>{}>* = nullptr
+  >
+  bool parse_arguments(OptionsStruct& options, int argc, ArgVT const argv) {
+    for (int i = 1; i < argc; i += 2) {
+      if (i + 1 == argc ||
+          !OptionsMap<OptionsStruct>::try_set(options, argv[i], argv[i + 1])) {
+        // unknown prefix found, or a flag without a value
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template<typename OptionsStruct, typename ArgVT,
+    typename std::enable_if_t<
+      std::is_same<ArgVT, char**>{} || std::is_same<ArgVT, const char**>{}>* = nullptr
+  >
+  optional_t<OptionsStruct> parse(int argc, ArgVT const argv) {
+    REFLSTATS_SCOPE(OptionsStruct, parse, 0);
+    OptionsStruct options;
+    if (!parse_arguments(options, argc, argv)) {
+      return std::experimental::nullopt;
+    }
+    return options;
+  }
+
+  // Later sources override earlier ones: the config file (JSON or key=value,
+  // skipped if config_path is null), then env_prefix_* environment variables,
+  // then argv. Each source writes straight into the options struct. Fails if
+  // any of them has a value that doesn't convert.
+  template<typename OptionsStruct, typename ArgVT,
+    typename std::enable_if_t<
+      std::is_same<ArgVT, char**>{} || std::is_same<ArgVT, const char**>{}>* = nullptr
+  >
+  optional_t<OptionsStruct> parse_layered(const char* config_path,
+      std::string_view env_prefix, int argc, ArgVT const argv) {
+    using Map = OptionsMap<OptionsStruct>;
+    OptionsStruct options;
+    if (config_path && !config::apply_file<Map>(options, config_path)) {
+      return std::experimental::nullopt;
+    }
+    if (!config::apply_environment<Map>(options, env_prefix) ||
+        !parse_arguments(options, argc, argv)) {
+      return std::experimental::nullopt;
+    }
+    return options;
+  }
+
+  // Loader for live::watcher. Every reload re-reads all three sources, so
+  // environment and argv overrides still win over the new config file.
+  //   auto load = reflopt::layered_loader<Opts>(path, "APP", argc, argv);
+  //   reflopt::live::watcher<Opts, decltype(load)> watch(path, load, *load());
+  template<typename OptionsStruct, typename ArgVT,
+    typename std::enable_if_t<
+      std::is_same<ArgVT, char**>{} || std::is_same<ArgVT, const char**>{}>* = nullptr
+  >
+  auto layered_loader(const char* config_path, std::string_view env_prefix,
+      int argc, ArgVT const argv) {
+    return [=]() {
+      return parse_layered<OptionsStruct>(config_path, env_prefix, argc, argv);
+    };
+  }
+
+template<size_t N>
+struct hana_string_from_literal {
+  static constexpr auto apply(const char (&literal)[N]) {
+    return apply_helper(literal, std::make_index_sequence<N>{});
+  }
+
+  template<size_t ...I>
+  static constexpr auto apply_helper(const char (&literal)[N], std::index_sequence<I...>&&) {
+    return hana::string_c<literal[I]...>;
+  }
+};
+
+}  // namespace reflopt
+
+
+#define BOOST_HANA_STRING_T(Literal) \
+  decltype(Literal ## _s)
+
+#define REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, Help) \
+  reflopt::Option<BOOST_HANA_STRING_T(#Identifier), BOOST_HANA_STRING_T(Flag), \
+      BOOST_HANA_STRING_T(ShortFlag), BOOST_HANA_STRING_T(Help)> \
+    reflopt_ ## Identifier ## _tag; \
+  Type Identifier
+
+#define REFLOPT_OPTION_3(Type, Identifier, Flag) \
+  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, "", "")
+
+#define REFLOPT_OPTION_4(Type, Identifier, Flag, ShortFlag) \
+  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, "")
+
+#define REFLOPT_OPTION_5(Type, Identifier, Flag, ShortFlag, Help) \
+  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, Help)
+
+#define REFLOPT_OPTION(...) \
+  VRM_PP_CAT(REFLOPT_OPTION_, VRM_PP_ARGCOUNT(__VA_ARGS__))(__VA_ARGS__) \
+
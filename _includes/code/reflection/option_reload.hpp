@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "diff_engine.hpp"
+
+namespace reflopt {
+namespace live {
+
+// Read-mostly cell holding the current version of a value. Readers take a
+// shared_ptr to it and keep that version alive for as long as they hold the
+// pointer, however many versions are published in the meantime.
+template<typename T>
+class published {
+public:
+  explicit published(T initial)
+  : current_(std::make_shared<const T>(std::move(initial))) {}
+
+  published(const published&) = delete;
+  published& operator=(const published&) = delete;
+
+  std::shared_ptr<const T> current() const {
+    return std::atomic_load_explicit(&current_, std::memory_order_acquire);
+  }
+
+  void publish(T next) {
+    std::atomic_store_explicit(&current_, std::make_shared<const T>(std::move(next)),
+      std::memory_order_release);
+  }
+
+private:
+  std::shared_ptr<const T> current_;
+};
+
+// Identifies one version of a file. The inode catches editors that save by
+// renaming a new file over the old one.
+struct file_stamp {
+  dev_t device = 0;
+  ino_t inode = 0;
+  off_t size = 0;
+  long seconds = 0;
+  long nanoseconds = 0;
+
+  static file_stamp of(const char* path) {
+    file_stamp result;
+    struct stat st;
+    if (::stat(path, &st) == 0) {
+      result.device = st.st_dev;
+      result.inode = st.st_ino;
+      result.size = st.st_size;
+      result.seconds = st.st_mtim.tv_sec;
+      result.nanoseconds = st.st_mtim.tv_nsec;
+    }
+    return result;
+  }
+
+  bool operator==(const file_stamp& other) const {
+    return device == other.device && inode == other.inode && size == other.size &&
+      seconds == other.seconds && nanoseconds == other.nanoseconds;
+  }
+  bool operator!=(const file_stamp& other) const {
+    return !(*this == other);
+  }
+};
+
+enum struct reload_result {
+  unchanged,
+  reloaded,
+  parse_failed
+};
+
+// Polls a config file and republishes the options whenever it changes.
+// load() re-reads every source and returns an empty optional on failure,
+// in which case the previous options stay current. on_change receives the
+// new options and the paths of the members that differ, as reported by
+// refldiff::member_diff (include the backend's refldiff.hpp).
+template<typename OptionsStruct, typename Load>
+class watcher {
+public:
+  using change_callback = std::function<void(const OptionsStruct&, const std::vector<std::string>&)>;
+
+  watcher(std::string path, Load load, OptionsStruct initial)
+  : path_(std::move(path)), load_(std::move(load)),
+    stamp_(file_stamp::of(path_.c_str())), options_(std::move(initial)) {}
+
+  watcher(const watcher&) = delete;
+  watcher& operator=(const watcher&) = delete;
+
+  ~watcher() {
+    stop();
+  }
+
+  std::shared_ptr<const OptionsStruct> current() const {
+    return options_.current();
+  }
+
+  // Checks the file once on the calling thread. Must not run concurrently
+  // with the polling thread. The stamp is only taken once a load succeeds,
+  // so a file that failed to parse, such as one caught half written, is
+  // loaded again on every poll until it parses.
+  reload_result poll(const change_callback& on_change = nullptr) {
+    const auto stamp = file_stamp::of(path_.c_str());
+    if (stamp == stamp_) {
+      return reload_result::unchanged;
+    }
+
+    auto next = load_();
+    if (!next) {
+      return reload_result::parse_failed;
+    }
+    stamp_ = stamp;
+    std::vector<std::string> changed;
+    refldiff::member_diff(*options_.current(), *next, "", changed);
+    if (changed.empty()) {
+      return reload_result::unchanged;
+    }
+    options_.publish(std::move(*next));
+    if (on_change) {
+      on_change(*options_.current(), changed);
+    }
+    return reload_result::reloaded;
+  }
+
+  void start(std::chrono::milliseconds interval, change_callback on_change = nullptr) {
+    stop();
+    stopping_ = false;
+    thread_ = std::thread([this, interval, on_change = std::move(on_change)]() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!stop_requested_.wait_for(lock, interval, [this]() { return stopping_; })) {
+        poll(on_change);
+      }
+    });
+  }
+
+  void stop() {
+    if (!thread_.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    stop_requested_.notify_one();
+    thread_.join();
+  }
+
+private:
+  std::string path_;
+  Load load_;
+  file_stamp stamp_;
+  published<OptionsStruct> options_;
+
+  // Only guards the stop flag; readers never touch it
+  std::mutex mutex_;
+  std::condition_variable stop_requested_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace live
+}  // namespace reflopt
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace reflopt {
+namespace table {
+
+// Constexpr helpers for laying out OptionsMap as flat arrays. Everything here
+// is a loop over std::array, so the compile-time cost grows with the number
+// of members instead of instantiating a template per map insertion.
+
+template<std::size_t N>
+constexpr std::size_t count(const std::array<bool, N>& flags) {
+  std::size_t result = 0;
+  for (bool flag : flags) {
+    result += flag;
+  }
+  return result;
+}
+
+// Positions of the set entries, in order
+template<std::size_t M, std::size_t N>
+constexpr std::array<std::size_t, M> indices_of(const std::array<bool, N>& flags) {
+  std::array<std::size_t, M> result{};
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    if (flags[i]) {
+      result[j++] = i;
+    }
+  }
+  return result;
+}
+
+template<std::size_t M>
+constexpr std::size_t count_flags(const std::array<std::string_view, M>& short_flags) {
+  std::size_t result = M;
+  for (auto flag : short_flags) {
+    result += !flag.empty();
+  }
+  return result;
+}
+
+// Every long flag, followed by the non-empty short flags, each with the
+// index of the option it sets
+template<std::size_t F>
+struct flag_list {
+  std::array<std::string_view, F> names;
+  std::array<std::size_t, F> owners;
+};
+
+template<std::size_t F, std::size_t M>
+constexpr flag_list<F> collect_flags(const std::array<std::string_view, M>& long_flags,
+    const std::array<std::string_view, M>& short_flags) {
+  flag_list<F> result{};
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < M; ++i) {
+    result.names[j] = long_flags[i];
+    result.owners[j++] = i;
+  }
+  for (std::size_t i = 0; i < M; ++i) {
+    if (!short_flags[i].empty()) {
+      result.names[j] = short_flags[i];
+      result.owners[j++] = i;
+    }
+  }
+  return result;
+}
+
+}  // namespace table
+}  // namespace reflopt
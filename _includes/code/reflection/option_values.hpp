@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <boost/lexical_cast/try_lexical_convert.hpp>
+
+namespace reflopt {
+namespace values {
+
+// Converts option text straight into the member. Nothing is copied out of
+// the input on the way: integers go through std::from_chars, string_view
+// members point into the input, and list members are filled element by
+// element from a comma-separated value. Only argv and the environment
+// outlive the options, so config files refuse string_view members.
+//
+// Character members take exactly one character, as they did through
+// lexical_cast. Floating point stays on lexical_cast too, since the standard
+// libraries these backends build with don't have floating point from_chars.
+
+template<typename T>
+struct is_std_vector : std::false_type {};
+template<typename T, typename A>
+struct is_std_vector<std::vector<T, A>> : std::true_type {};
+
+template<typename T>
+struct is_std_array : std::false_type {};
+template<typename T, std::size_t N>
+struct is_std_array<std::array<T, N>> : std::true_type {};
+
+// Calls f(element) for every comma-separated element of src, stopping at the
+// first call that returns false
+template<typename F>
+bool for_each_element(std::string_view src, F&& f) {
+  while (true) {
+    const auto comma = src.find(',');
+    if (!f(src.substr(0, comma))) {
+      return false;
+    }
+    if (comma == std::string_view::npos) {
+      return true;
+    }
+    src.remove_prefix(comma + 1);
+  }
+}
+
+template<typename T>
+using is_character = std::disjunction<std::is_same<T, char>, std::is_same<T, signed char>,
+  std::is_same<T, unsigned char>>;
+
+template<typename T>
+bool parse_value(std::string_view src, T& dst) {
+  if constexpr (std::is_same<T, bool>{}) {
+    if (src == "true" || src == "1") {
+      dst = true;
+    } else if (src == "false" || src == "0") {
+      dst = false;
+    } else {
+      return false;
+    }
+    return true;
+  } else if constexpr (is_character<T>{}) {
+    if (src.size() != 1) {
+      return false;
+    }
+    dst = static_cast<T>(src[0]);
+    return true;
+  } else if constexpr (std::is_integral<T>{}) {
+    T result;
+    const auto [end, error] = std::from_chars(src.data(), src.data() + src.size(), result);
+    if (error != std::errc() || end != src.data() + src.size()) {
+      return false;
+    }
+    dst = result;
+    return true;
+  } else if constexpr (std::is_same<T, std::string_view>{}) {
+    dst = src;
+    return true;
+  } else if constexpr (std::is_same<T, std::string>{}) {
+    // Reuses the member's capacity when it already has enough
+    dst.assign(src.data(), src.size());
+    return true;
+  } else if constexpr (is_std_vector<T>{}) {
+    dst.clear();
+    if (src.empty()) {
+      return true;
+    }
+    return for_each_element(src, [&dst](std::string_view element) {
+      dst.emplace_back();
+      return parse_value(element, dst.back());
+    });
+  } else if constexpr (is_std_array<T>{}) {
+    std::size_t i = 0;
+    const bool parsed = for_each_element(src, [&dst, &i](std::string_view element) {
+      return i < dst.size() && parse_value(element, dst[i++]);
+    });
+    return parsed && i == dst.size();
+  } else {
+    // Floating point, and anything else with a stream extraction operator
+    T result;
+    if (!boost::conversion::try_lexical_convert(src.data(), src.size(), result)) {
+      return false;
+    }
+    dst = std::move(result);
+    return true;
+  }
+}
+
+}  // namespace values
+}  // namespace reflopt
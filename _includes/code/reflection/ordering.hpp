@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+
+namespace reflcompare {
+
+namespace metap = jk::metaprogramming;
+namespace refl = jk::refl_utilities;
+
+template<typename T>
+using less_than_comparable = decltype(std::declval<const T&>() < std::declval<const T&>());
+
+// Three-way comparison of reflected records in member declaration order.
+// Returns <0, 0 or >0.
+template<typename T>
+int compare(const T& a, const T& b);
+
+template<typename T>
+int compare_values(const T& a, const T& b) {
+  if constexpr (std::is_same<T, std::string>{} || std::is_same<T, std::string_view>{}) {
+    const int result = a.compare(b);
+    return (result > 0) - (result < 0);
+  } else if constexpr (metap::is_detected<metap::iterable, T>{}) {
+    // Lexicographic, recursing so that containers of records work too
+    auto ia = a.begin();
+    auto ib = b.begin();
+    for (; ia != a.end() && ib != b.end(); ++ia, ++ib) {
+      if (const int result = compare_values(*ia, *ib); result != 0) {
+        return result;
+      }
+    }
+    return (ib == b.end()) - (ia == a.end());
+  } else if constexpr (metap::is_detected<less_than_comparable, T>{}) {
+    if (a < b) {
+      return -1;
+    }
+    if (b < a) {
+      return 1;
+    }
+    return 0;
+  } else {
+    return compare(a, b);
+  }
+}
+
+// Lexicographic three-way comparison over a chosen list of members, e.g.
+// compare_members<&Record::score, &Record::id>(a, b)
+template<auto ...Members, typename T>
+int compare_members(const T& a, const T& b) {
+  int result = 0;
+  static_cast<void>((((result = compare_values(a.*Members, b.*Members)) == 0) && ...));
+  return result;
+}
+
+// Comparator for std::sort and friends
+template<auto ...Members>
+struct less_by {
+  template<typename T>
+  bool operator()(const T& a, const T& b) const {
+    return compare_members<Members...>(a, b) < 0;
+  }
+};
+
+// Lexicographic over members in declaration order
+template<typename T>
+int compare(const T& a, const T& b) {
+  static_assert(refl::is_record<T>{},
+    "Type contained a member which has no ordering defined.");
+  int result = 0;
+  refl::all_members<T>([&a, &b, &result](const auto& member) {
+    result = compare_values(a.*member.pointer, b.*member.pointer);
+    return result == 0;
+  });
+  return result;
+}
+
+template<typename T>
+struct less {
+  bool operator()(const T& a, const T& b) const {
+    return compare(a, b) < 0;
+  }
+};
+
+}  // namespace reflcompare
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "byte_buffer.hpp"
+#include "hot_cold.hpp"
+#include "intern_pool.hpp"
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+#include "parallel_utilities.hpp"
+#include "soa_vector.hpp"
+
+// serialize with options, for single objects too large to encode on one
+// thread. Included at the end of the backend's reflser.hpp, after the
+// two-argument serialize it builds on.
+namespace reflser {
+
+namespace parallel = jk::parallel_utilities;
+
+struct serialize_options {
+  // Ranges with at least this many elements are split and their pieces
+  // encoded concurrently. Everything smaller takes the serial path.
+  std::size_t parallel_threshold = std::size_t(1) << 16;
+  unsigned threads = parallel::default_threads();
+};
+
+namespace parallel_detail {
+
+namespace metap = jk::metaprogramming;
+namespace refl = jk::refl_utilities;
+
+template<typename T>
+using random_access = std::is_base_of<std::random_access_iterator_tag,
+  typename std::iterator_traits<decltype(std::declval<const T&>().begin())>::iterator_category>;
+
+// Ranges and records can hold a large range further down; anything else is
+// written by serialize in one piece
+template<typename T>
+constexpr bool may_split() {
+  if constexpr (std::is_same<T, std::string>{} ||
+                std::is_same<T, jk::intern::interned_string>{} ||
+                refl::is_soa_vector<T>{} || refl::is_byte_buffer<T>{}) {
+    return false;
+  } else {
+    return metap::is_detected<metap::iterable, T>{} || refl::is_hot_cold<T>{} ||
+      refl::is_record<T>{};
+  }
+}
+
+// Each task encodes a run of elements into its own buffer, with the same
+// separators serialize uses, and the buffers are joined in order
+template<typename T>
+serialize_result split_range(const T& src, std::size_t n, std::string& dst,
+    const serialize_options& options) {
+  const unsigned threads = std::max(options.threads, 1u);
+  const std::size_t n_parts = std::min<std::size_t>(n, std::size_t(threads) * 4);
+  const std::size_t part_size = (n + n_parts - 1) / n_parts;
+
+  std::vector<std::string> parts((n + part_size - 1) / part_size);
+  std::vector<serialize_result> results(parts.size(), serialize_result::success);
+  parallel::parallel_for(parts.size(), 1, threads, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t p = begin; p < end; ++p) {
+      const auto first = src.begin() + p * part_size;
+      const auto last = src.begin() + std::min(n, (p + 1) * part_size);
+      for (auto it = first; it != last; ++it) {
+        auto entry = *it;
+        if (results[p] = serialize(entry, parts[p]); results[p] != serialize_result::success) {
+          break;
+        }
+        if (it != last - 1) {
+          parts[p] += ", ";
+        }
+      }
+    }
+  });
+
+  for (auto result : results) {
+    if (result != serialize_result::success) {
+      return result;
+    }
+  }
+  std::size_t size = dst.size() + 4;
+  for (const auto& part : parts) {
+    size += part.size() + 2;
+  }
+  dst.reserve(size);
+  dst += "[ ";
+  for (std::size_t p = 0; p < parts.size(); ++p) {
+    dst += parts[p];
+    if (p + 1 < parts.size()) {
+      dst += ", ";
+    }
+  }
+  dst += " ]";
+  return serialize_result::success;
+}
+
+}  // namespace parallel_detail
+
+// The same JSON as serialize(src, dst). Records are walked member by member
+// and any random access range of at least options.parallel_threshold
+// elements, such as a std::vector member holding a snapshot's samples, is
+// split across options.threads threads.
+template<typename T>
+serialize_result serialize(const T& src, std::string& dst, const serialize_options& options) {
+  namespace refl = jk::refl_utilities;
+  namespace metap = jk::metaprogramming;
+
+  if constexpr (!parallel_detail::may_split<T>()) {
+    return serialize(src, dst);
+  } else if constexpr (metap::is_detected<metap::iterable, T>{}) {
+    if constexpr (parallel_detail::random_access<T>{}) {
+      const std::size_t n = static_cast<std::size_t>(src.end() - src.begin());
+      if (n >= std::max<std::size_t>(options.parallel_threshold, 1) && options.threads > 1) {
+        return parallel_detail::split_range(src, n, dst, options);
+      }
+    }
+    // Small ranges don't look for large ranges inside their elements
+    return serialize(src, dst);
+  } else if constexpr (refl::is_hot_cold<T>{}) {
+    return serialize(src.record(), dst, options);
+  } else {
+    dst += "{ ";
+    serialize_result result = serialize_result::success;
+    bool first = true;
+    refl::all_members<T>([&src, &dst, &options, &result, &first](const auto& member) {
+      using info = std::decay_t<decltype(member)>;
+      if (!first) {
+        dst += ", ";
+      }
+      first = false;
+      dst += "\"";
+      dst += member.name;
+      dst += "\" : ";
+      result = serialize(src.*info::pointer, dst, options);
+      return result == serialize_result::success;
+    });
+    if (result == serialize_result::success) {
+      dst += " }";
+    }
+    return result;
+  }
+}
+
+}  // namespace reflser
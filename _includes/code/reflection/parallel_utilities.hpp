@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace jk {
+namespace parallel_utilities {
+
+inline unsigned default_threads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Calls f(begin, end) over chunks of [0, n). Threads take chunks from a shared
+// counter, so uneven chunks still balance. Runs inline if there is only one
+// chunk or one thread.
+template<typename F>
+void parallel_for(std::size_t n, std::size_t chunk, unsigned threads, F&& f) {
+  if (n == 0) {
+    return;
+  }
+  chunk = std::max<std::size_t>(chunk, 1);
+  const std::size_t n_chunks = (n + chunk - 1) / chunk;
+  threads = static_cast<unsigned>(std::min<std::size_t>(std::max(threads, 1u), n_chunks));
+  if (threads == 1) {
+    f(std::size_t(0), n);
+    return;
+  }
+
+  std::atomic<std::size_t> next{0};
+  auto worker = [&]() {
+    for (std::size_t c = next.fetch_add(1, std::memory_order_relaxed); c < n_chunks;
+         c = next.fetch_add(1, std::memory_order_relaxed)) {
+      f(c * chunk, std::min(n, (c + 1) * chunk));
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned i = 1; i < threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : workers) {
+    t.join();
+  }
+}
+
+}  // namespace parallel_utilities
+}  // namespace jk
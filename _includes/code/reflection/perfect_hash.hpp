@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace jk {
+namespace perfect_hash {
+
+// Seeded FNV-1a with a final avalanche step, so that different seeds give
+// unrelated low bits.
+constexpr std::uint32_t hash(std::string_view key, std::uint32_t seed) {
+  std::uint32_t h = 2166136261u ^ seed;
+  for (char c : key) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 16777619u;
+  }
+  h ^= h >> 15;
+  h *= 0x2c1b3c6du;
+  h ^= h >> 12;
+  return h;
+}
+
+// Smallest power of two that is at least n
+constexpr std::size_t power_of_two_at_least(std::size_t n) {
+  std::size_t size = 1;
+  while (size < n) {
+    size <<= 1;
+  }
+  return size;
+}
+
+// Twice the number of keys, rounded up to a power of two
+constexpr std::size_t table_size(std::size_t n_keys) {
+  return power_of_two_at_least(2 * n_keys);
+}
+
+// About four keys per bucket
+constexpr std::size_t bucket_count(std::size_t n_keys) {
+  return power_of_two_at_least((n_keys + 3) / 4);
+}
+
+static constexpr std::uint32_t max_seed = 1 << 16;
+
+// Hash and displace: a key's bucket comes from one fixed hash, and each
+// bucket stores the seed that sends its keys to free slots. Searching a seed
+// per bucket of a few keys instead of one seed for the whole key set keeps
+// construction near-linear, even for thousands of keys.
+template<std::size_t N>
+struct table {
+  static constexpr std::size_t size = table_size(N);
+  static constexpr std::size_t n_buckets = bucket_count(N);
+  static constexpr std::size_t npos = N;
+
+  bool valid = false;
+  std::array<std::string_view, N> keys = {};
+  std::array<std::uint32_t, n_buckets> seeds = {};
+  // index into keys, or npos for an empty slot
+  std::array<std::size_t, size> slots = {};
+
+  static constexpr std::size_t bucket_of(std::string_view key) {
+    return (hash(key, 0) >> 16) & (n_buckets - 1);
+  }
+
+  // Two hashes and at most one string comparison per lookup
+  constexpr std::size_t find(std::string_view key) const {
+    const std::size_t index = slots[hash(key, seeds[bucket_of(key)]) & (size - 1)];
+    if (index != npos && keys[index] == key) {
+      return index;
+    }
+    return npos;
+  }
+};
+
+template<std::size_t N>
+constexpr table<N> make_table(const std::array<std::string_view, N>& keys) {
+  using table_t = table<N>;
+  table_t result;
+  result.keys = keys;
+  for (auto& slot : result.slots) {
+    slot = table_t::npos;
+  }
+
+  // Group the keys by bucket
+  std::array<std::size_t, table_t::n_buckets + 1> bucket_start = {};
+  for (std::size_t i = 0; i < N; ++i) {
+    ++bucket_start[table_t::bucket_of(keys[i]) + 1];
+  }
+  std::size_t largest = 0;
+  for (std::size_t b = 0; b < table_t::n_buckets; ++b) {
+    largest = bucket_start[b + 1] > largest ? bucket_start[b + 1] : largest;
+    bucket_start[b + 1] += bucket_start[b];
+  }
+  std::array<std::size_t, N> by_bucket = {};
+  std::array<std::size_t, table_t::n_buckets> filled = {};
+  for (std::size_t i = 0; i < N; ++i) {
+    const auto b = table_t::bucket_of(keys[i]);
+    by_bucket[bucket_start[b] + filled[b]++] = i;
+  }
+
+  // Duplicate keys always share a bucket, and no seed could separate them
+  for (std::size_t b = 0; b < table_t::n_buckets; ++b) {
+    for (std::size_t j = bucket_start[b]; j < bucket_start[b + 1]; ++j) {
+      for (std::size_t k = j + 1; k < bucket_start[b + 1]; ++k) {
+        if (keys[by_bucket[j]] == keys[by_bucket[k]]) {
+          return result;
+        }
+      }
+    }
+  }
+
+  // Place the largest buckets first, while most slots are still free
+  std::array<std::size_t, table_t::size> placed = {};
+  for (std::size_t bucket_size = largest; bucket_size > 0; --bucket_size) {
+    for (std::size_t b = 0; b < table_t::n_buckets; ++b) {
+      if (bucket_start[b + 1] - bucket_start[b] != bucket_size) {
+        continue;
+      }
+      bool found = false;
+      for (std::uint32_t seed = 1; seed < max_seed && !found; ++seed) {
+        std::size_t n_placed = 0;
+        bool collision = false;
+        for (std::size_t k = bucket_start[b]; k < bucket_start[b + 1] && !collision; ++k) {
+          const auto slot = hash(keys[by_bucket[k]], seed) & (table_t::size - 1);
+          if (result.slots[slot] != table_t::npos) {
+            collision = true;
+          } else {
+            result.slots[slot] = by_bucket[k];
+            placed[n_placed++] = slot;
+          }
+        }
+        if (collision) {
+          // Undo this attempt's slots before trying the next seed
+          for (std::size_t k = 0; k < n_placed; ++k) {
+            result.slots[placed[k]] = table_t::npos;
+          }
+        } else {
+          result.seeds[b] = seed;
+          found = true;
+        }
+      }
+      if (!found) {
+        return result;
+      }
+    }
+  }
+  result.valid = true;
+  return result;
+}
+
+}  // namespace perfect_hash
+}  // namespace jk
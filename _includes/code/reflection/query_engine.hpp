@@ -0,0 +1,431 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "byte_utilities.hpp"
+#include "member_key.hpp"
+#include "parallel_utilities.hpp"
+
+namespace reflquery {
+
+namespace bytes = jk::byte_utilities;
+namespace parallel = jk::parallel_utilities;
+namespace refl = jk::refl_utilities;
+
+// Members are named by member pointer or by name, as in refl::member_of. In
+// group_by, sources are members of the input records and targets are members
+// of the result struct.
+//
+// struct by_region {
+//   std::string region;
+//   std::size_t requests;
+//   std::int64_t total_latency;
+// };
+// auto rows = reflquery::group_by<by_region,
+//   reflquery::key<&request::region, &by_region::region>,
+//   reflquery::count<&by_region::requests>,
+//   reflquery::sum<&request::latency, &by_region::total_latency>>(requests);
+
+template<auto Source, auto Target>
+struct key {
+  template<typename T>
+  static constexpr auto source = refl::member_of<T, Source>();
+
+  template<typename Result, typename T>
+  static void init(Result& result, const T& record) {
+    result.*refl::member_of<Result, Target>() = record.*source<T>;
+  }
+  template<typename Result, typename T>
+  static void add(Result&, const T&) {}
+};
+
+template<auto Target>
+struct count {
+  template<typename Result, typename T>
+  static void init(Result& result, const T&) {
+    result.*refl::member_of<Result, Target>() = 1;
+  }
+  template<typename Result, typename T>
+  static void add(Result& result, const T&) {
+    ++(result.*refl::member_of<Result, Target>());
+  }
+};
+
+template<auto Source, auto Target>
+struct sum {
+  template<typename Result, typename T>
+  static void init(Result& result, const T& record) {
+    constexpr auto target = refl::member_of<Result, Target>();
+    result.*target = static_cast<refl::member_type_t<target>>(
+      record.*refl::member_of<T, Source>());
+  }
+  template<typename Result, typename T>
+  static void add(Result& result, const T& record) {
+    result.*refl::member_of<Result, Target>() += record.*refl::member_of<T, Source>();
+  }
+};
+
+template<auto Source, auto Target>
+struct min {
+  template<typename Result, typename T>
+  static void init(Result& result, const T& record) {
+    result.*refl::member_of<Result, Target>() = record.*refl::member_of<T, Source>();
+  }
+  template<typename Result, typename T>
+  static void add(Result& result, const T& record) {
+    auto& current = result.*refl::member_of<Result, Target>();
+    const auto& value = record.*refl::member_of<T, Source>();
+    if (value < current) {
+      current = value;
+    }
+  }
+};
+
+template<auto Source, auto Target>
+struct max {
+  template<typename Result, typename T>
+  static void init(Result& result, const T& record) {
+    result.*refl::member_of<Result, Target>() = record.*refl::member_of<T, Source>();
+  }
+  template<typename Result, typename T>
+  static void add(Result& result, const T& record) {
+    auto& current = result.*refl::member_of<Result, Target>();
+    const auto& value = record.*refl::member_of<T, Source>();
+    if (current < value) {
+      current = value;
+    }
+  }
+};
+
+// Default row type of hash_join, serializable whenever L and R are
+template<typename L, typename R>
+struct joined {
+  L left;
+  R right;
+};
+
+struct query_options {
+  unsigned threads = parallel::default_threads();
+  // Records per partition the inputs are split into. Each partition gets its
+  // own hash table, which should stay small enough to be cache resident.
+  std::size_t partition_size = 1 << 12;
+};
+
+template<typename K>
+using is_integer_key = std::disjunction<std::is_integral<K>, std::is_enum<K>>;
+
+// The type both sides of a join hash their keys as. Integer keys are
+// converted to their common type first, as == converts them, so an int32_t
+// key of -1 and a uint32_t key of 0xFFFFFFFF land in the same partition.
+template<typename L, typename R, bool = is_integer_key<L>{} && is_integer_key<R>{}>
+struct hashed_key {
+  using type = L;
+};
+template<typename L, typename R>
+struct hashed_key<L, R, true> {
+  using type = std::common_type_t<L, R>;
+};
+
+// Keys that compare equal hash equally when they are integers of any type
+// hashed as the same As, or are both convertible to std::string_view, so a
+// std::string key joins a std::string_view key. Other keys hash through
+// std::hash<K>, which only agrees with == within one type.
+template<typename As, typename K>
+std::uint64_t key_hash(const K& key) {
+  if constexpr (is_integer_key<K>{}) {
+    const auto value = static_cast<std::uint64_t>(static_cast<As>(key));
+    return bytes::hash(&value, sizeof(value));
+  } else if constexpr (std::is_convertible<const K&, std::string_view>{}) {
+    const std::string_view value = key;
+    return bytes::hash(value.data(), value.size());
+  } else {
+    const std::uint64_t value = std::hash<K>{}(key);
+    return bytes::hash(&value, sizeof(value));
+  }
+}
+
+// Record indices grouped by partition, in input order within a partition.
+// Partition p is [offsets[p], offsets[p + 1]).
+struct partitions {
+  std::vector<std::size_t> indices;
+  std::vector<std::uint64_t> hashes;
+  std::vector<std::size_t> offsets;
+
+  std::size_t size() const {
+    return offsets.size() - 1;
+  }
+};
+
+// Only depends on the input size, so rows come out in the same order for
+// any thread count
+inline unsigned partition_bits(std::size_t n, const query_options& options) {
+  const std::size_t wanted = n / std::max<std::size_t>(options.partition_size, 1);
+  unsigned bits = 0;
+  while (bits < 16 && (std::size_t(1) << bits) < wanted) {
+    ++bits;
+  }
+  return bits;
+}
+
+// The top bits of the hash pick the partition, the low bits the slot in the
+// partition's table, so the two stay independent
+inline std::size_t partition_of(std::uint64_t hash, unsigned bits) {
+  return bits == 0 ? 0 : static_cast<std::size_t>(hash >> (64 - bits));
+}
+
+// Two passes over one contiguous block of the input per thread: count each
+// block's records per partition, then scatter them to offsets computed from
+// the counts. Records keep their input order within a partition, so the
+// result doesn't depend on the thread count.
+template<auto Member, typename Hashed, typename T>
+partitions partition_by_key(const std::vector<T>& records, unsigned bits,
+    const query_options& options) {
+  static constexpr std::size_t min_block = 1 << 14;
+  const std::size_t n = records.size();
+  const std::size_t n_partitions = std::size_t(1) << bits;
+  const std::size_t n_blocks = std::max<std::size_t>(1, std::min<std::size_t>(
+    std::max(options.threads, 1u), n / min_block));
+  const std::size_t block = (n + n_blocks - 1) / n_blocks;
+
+  std::vector<std::uint64_t> hashes(n);
+  std::vector<std::size_t> counts(n_blocks * n_partitions);
+  parallel::parallel_for(n_blocks, 1, options.threads, [&](std::size_t first, std::size_t last) {
+    for (std::size_t b = first; b < last; ++b) {
+      std::size_t* histogram = &counts[b * n_partitions];
+      for (std::size_t i = b * block; i < std::min(n, (b + 1) * block); ++i) {
+        hashes[i] = key_hash<Hashed>(records[i].*Member);
+        ++histogram[partition_of(hashes[i], bits)];
+      }
+    }
+  });
+
+  partitions result;
+  result.offsets.resize(n_partitions + 1);
+  std::size_t total = 0;
+  for (std::size_t p = 0; p < n_partitions; ++p) {
+    result.offsets[p] = total;
+    for (std::size_t b = 0; b < n_blocks; ++b) {
+      const std::size_t count = counts[b * n_partitions + p];
+      counts[b * n_partitions + p] = total;
+      total += count;
+    }
+  }
+  result.offsets[n_partitions] = total;
+
+  result.indices.resize(n);
+  result.hashes.resize(n);
+  parallel::parallel_for(n_blocks, 1, options.threads, [&](std::size_t first, std::size_t last) {
+    for (std::size_t b = first; b < last; ++b) {
+      std::size_t* offsets = &counts[b * n_partitions];
+      for (std::size_t i = b * block; i < std::min(n, (b + 1) * block); ++i) {
+        const std::size_t to = offsets[partition_of(hashes[i], bits)]++;
+        result.indices[to] = i;
+        result.hashes[to] = hashes[i];
+      }
+    }
+  });
+  return result;
+}
+
+// Open addressing over the entries of one partition; slots hold entry + 1
+class partition_table {
+public:
+  explicit partition_table(std::size_t n) {
+    std::size_t capacity = 16;
+    while (capacity < 2 * n) {
+      capacity *= 2;
+    }
+    slots_.assign(capacity, 0);
+    mask_ = capacity - 1;
+  }
+
+  // Calls match(entry) for occupied slots along the probe sequence of hash
+  // until it returns true, and returns the slot it stopped at
+  template<typename Match>
+  std::size_t probe(std::uint64_t hash, Match&& match) const {
+    std::size_t slot = static_cast<std::size_t>(hash) & mask_;
+    while (slots_[slot] != 0 && !match(slots_[slot] - 1)) {
+      slot = (slot + 1) & mask_;
+    }
+    return slot;
+  }
+
+  bool empty(std::size_t slot) const {
+    return slots_[slot] == 0;
+  }
+  std::size_t entry(std::size_t slot) const {
+    return slots_[slot] - 1;
+  }
+  void insert(std::size_t slot, std::size_t entry) {
+    slots_[slot] = entry + 1;
+  }
+
+private:
+  std::vector<std::size_t> slots_;
+  std::size_t mask_;
+};
+
+template<typename Result, typename Key, typename ...Aggregates, typename T>
+void group_partition(const std::vector<T>& records, const partitions& parts, std::size_t p,
+    std::vector<Result>& out) {
+  constexpr auto key_member = Key::template source<T>;
+  const std::size_t begin = parts.offsets[p];
+  const std::size_t end = parts.offsets[p + 1];
+
+  partition_table table(end - begin);
+  // Per group, the partition entry of its first record
+  std::vector<std::size_t> firsts;
+  for (std::size_t e = begin; e < end; ++e) {
+    const T& record = records[parts.indices[e]];
+    const std::size_t slot = table.probe(parts.hashes[e], [&](std::size_t group) {
+      const std::size_t first = firsts[group];
+      return parts.hashes[first] == parts.hashes[e] &&
+        records[parts.indices[first]].*key_member == record.*key_member;
+    });
+    if (table.empty(slot)) {
+      table.insert(slot, firsts.size());
+      firsts.push_back(e);
+      out.emplace_back();
+      Key::init(out.back(), record);
+      static_cast<void>((Aggregates::init(out.back(), record), ...));
+    } else {
+      static_cast<void>((Aggregates::add(out[table.entry(slot)], record), ...));
+    }
+  }
+}
+
+// One Result per distinct key. Key is a key<Source, Target>; each aggregate
+// is a count, sum, min or max spec. Groups come out partition by partition,
+// in order of first appearance within a partition.
+template<typename Result, typename Key, typename ...Aggregates, typename T>
+std::vector<Result> group_by(const std::vector<T>& records, const query_options& options = {}) {
+  const unsigned bits = partition_bits(records.size(), options);
+  constexpr auto source = Key::template source<T>;
+  using key_t = std::decay_t<decltype(std::declval<const T&>().*source)>;
+  const auto parts = partition_by_key<source, key_t>(records, bits, options);
+
+  std::vector<std::vector<Result>> groups(parts.size());
+  parallel::parallel_for(parts.size(), 1, options.threads,
+    [&](std::size_t begin, std::size_t end) {
+      for (std::size_t p = begin; p < end; ++p) {
+        group_partition<Result, Key, Aggregates...>(records, parts, p, groups[p]);
+      }
+    });
+
+  std::vector<Result> result;
+  std::size_t total = 0;
+  for (const auto& g : groups) {
+    total += g.size();
+  }
+  result.reserve(total);
+  for (auto& g : groups) {
+    std::move(g.begin(), g.end(), std::back_inserter(result));
+  }
+  return result;
+}
+
+// Inner equi-join: make_row(l, r) for every pair with equal keys, as a
+// std::vector of whatever make_row returns. Both sides are partitioned by the
+// key hash, then each partition builds a table over its right records and
+// probes it with its left records. Rows come out partition by partition, in
+// left order, and for each left record in right order.
+template<auto LeftKey, auto RightKey, typename L, typename R, typename F>
+auto hash_join(const std::vector<L>& left, const std::vector<R>& right, F&& make_row,
+    const query_options& options = {})
+    -> std::vector<std::decay_t<std::invoke_result_t<F&, const L&, const R&>>> {
+  using row_t = std::decay_t<std::invoke_result_t<F&, const L&, const R&>>;
+  constexpr auto left_key = refl::member_of<L, LeftKey>();
+  constexpr auto right_key = refl::member_of<R, RightKey>();
+  using left_key_t = std::decay_t<decltype(std::declval<const L&>().*left_key)>;
+  using right_key_t = std::decay_t<decltype(std::declval<const R&>().*right_key)>;
+  using hashed_t = typename hashed_key<left_key_t, right_key_t>::type;
+  static_assert((is_integer_key<left_key_t>{} && is_integer_key<right_key_t>{}) ||
+      (std::is_convertible<const left_key_t&, std::string_view>{} &&
+       std::is_convertible<const right_key_t&, std::string_view>{}) ||
+      std::is_same<left_key_t, right_key_t>{},
+    "Keys of different types only join when both are integers or both are strings.");
+
+  const unsigned bits = partition_bits(std::max(left.size(), right.size()), options);
+  const auto left_parts = partition_by_key<left_key, hashed_t>(left, bits, options);
+  const auto right_parts = partition_by_key<right_key, hashed_t>(right, bits, options);
+
+  std::vector<std::vector<row_t>> rows(left_parts.size());
+  parallel::parallel_for(left_parts.size(), 1, options.threads,
+    [&](std::size_t begin, std::size_t end) {
+      for (std::size_t p = begin; p < end; ++p) {
+        const std::size_t right_begin = right_parts.offsets[p];
+        const std::size_t right_end = right_parts.offsets[p + 1];
+        if (right_begin == right_end) {
+          continue;
+        }
+
+        // Right records with equal keys are chained in input order
+        partition_table table(right_end - right_begin);
+        std::vector<std::size_t> heads;
+        std::vector<std::size_t> next(right_end - right_begin, right_end);
+        std::vector<std::size_t> tails;
+        for (std::size_t e = right_begin; e < right_end; ++e) {
+          const R& record = right[right_parts.indices[e]];
+          const std::size_t slot = table.probe(right_parts.hashes[e], [&](std::size_t key) {
+            const std::size_t head = heads[key];
+            return right_parts.hashes[head] == right_parts.hashes[e] &&
+              right[right_parts.indices[head]].*right_key == record.*right_key;
+          });
+          if (table.empty(slot)) {
+            table.insert(slot, heads.size());
+            heads.push_back(e);
+            tails.push_back(e);
+          } else {
+            const std::size_t key = table.entry(slot);
+            next[tails[key] - right_begin] = e;
+            tails[key] = e;
+          }
+        }
+
+        for (std::size_t e = left_parts.offsets[p]; e < left_parts.offsets[p + 1]; ++e) {
+          const L& record = left[left_parts.indices[e]];
+          const std::size_t slot = table.probe(left_parts.hashes[e], [&](std::size_t key) {
+            const std::size_t head = heads[key];
+            return right_parts.hashes[head] == left_parts.hashes[e] &&
+              right[right_parts.indices[head]].*right_key == record.*left_key;
+          });
+          if (table.empty(slot)) {
+            continue;
+          }
+          for (std::size_t match = heads[table.entry(slot)]; match != right_end;
+               match = next[match - right_begin]) {
+            rows[p].push_back(make_row(record, right[right_parts.indices[match]]));
+          }
+        }
+      }
+    });
+
+  std::vector<row_t> result;
+  std::size_t total = 0;
+  for (const auto& r : rows) {
+    total += r.size();
+  }
+  result.reserve(total);
+  for (auto& r : rows) {
+    std::move(r.begin(), r.end(), std::back_inserter(result));
+  }
+  return result;
+}
+
+// Rows are joined<L, R> copies of each matching pair
+template<auto LeftKey, auto RightKey, typename L, typename R>
+std::vector<joined<L, R>> hash_join(const std::vector<L>& left, const std::vector<R>& right,
+    const query_options& options = {}) {
+  return hash_join<LeftKey, RightKey>(left, right,
+    [](const L& l, const R& r) { return joined<L, R>{l, r}; }, options);
+}
+
+}  // namespace reflquery
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ordering.hpp"
+
+namespace reflsort {
+
+// Order-preserving byte encodings: comparing two encoded keys with memcmp
+// gives the same order as reflcompare::compare_values on the values.
+template<typename T, typename Enable = void>
+struct key_encoding;
+
+template<typename T, bool = std::is_enum<T>{}>
+struct integer_of {
+  using type = T;
+};
+
+template<typename T>
+struct integer_of<T, true> {
+  using type = std::underlying_type_t<T>;
+};
+
+template<typename T>
+struct key_encoding<T, std::enable_if_t<std::is_integral<T>{} || std::is_enum<T>{}>> {
+  static constexpr bool fixed_size = true;
+  static constexpr std::size_t size = sizeof(T);
+
+  static void encode(const T& value, unsigned char* out) {
+    using integer_t = typename integer_of<T>::type;
+    if constexpr (std::is_same<integer_t, bool>{}) {
+      out[0] = value ? 1 : 0;
+    } else {
+      using unsigned_t = std::make_unsigned_t<integer_t>;
+      auto bits = static_cast<unsigned_t>(value);
+      if constexpr (std::is_signed<integer_t>{}) {
+        // Flip the sign bit so negative values sort first
+        bits ^= unsigned_t(1) << (8 * sizeof(T) - 1);
+      }
+      // Big-endian, so the most significant byte is compared first
+      for (std::size_t i = 0; i < size; ++i) {
+        out[i] = static_cast<unsigned char>(bits >> (8 * (size - 1 - i)));
+      }
+    }
+  }
+};
+
+// NaN has no place in the order that < gives. Its key puts a NaN with the
+// sign bit clear after +infinity and one with the sign bit set before
+// -infinity.
+template<typename T>
+struct key_encoding<T, std::enable_if_t<std::is_floating_point<T>{}>> {
+  static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Unsupported floating point width");
+
+  static constexpr bool fixed_size = true;
+  static constexpr std::size_t size = sizeof(T);
+
+  static void encode(const T& value, unsigned char* out) {
+    using bits_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+    constexpr bits_t sign = bits_t(1) << (8 * sizeof(T) - 1);
+    // -0.0 == +0.0, so both get the key of +0.0 and keep their input order
+    const T canonical = value == T(0) ? T(0) : value;
+    bits_t bits;
+    std::memcpy(&bits, &canonical, sizeof(T));
+    // Negative values have their magnitude order reversed
+    bits = (bits & sign) ? ~bits : (bits | sign);
+    for (std::size_t i = 0; i < size; ++i) {
+      out[i] = static_cast<unsigned char>(bits >> (8 * (size - 1 - i)));
+    }
+  }
+};
+
+// Strings are variable length: a zero byte is escaped as 00 FF and the key is
+// terminated by 00 00, so a proper prefix sorts before any extension of it.
+template<typename T>
+struct key_encoding<T, std::enable_if_t<
+    std::is_same<T, std::string>{} || std::is_same<T, std::string_view>{}>> {
+  static constexpr bool fixed_size = false;
+
+  static void encode(const T& value, std::string& out) {
+    for (char c : value) {
+      out += c;
+      if (c == '\0') {
+        out += '\xff';
+      }
+    }
+    out += '\0';
+    out += '\0';
+  }
+};
+
+template<typename T, auto ...Members>
+constexpr bool is_fixed_size_key() {
+  return (key_encoding<std::decay_t<decltype(std::declval<const T&>().*Members)>>::fixed_size && ...);
+}
+
+template<typename T, auto ...Members>
+constexpr std::size_t fixed_key_size() {
+  return (key_encoding<std::decay_t<decltype(std::declval<const T&>().*Members)>>::size + ...);
+}
+
+// Fixed-width key for members that are all integral, enum or floating point
+template<auto ...Members, typename T>
+auto encode_fixed_key(const T& record) {
+  static_assert(is_fixed_size_key<T, Members...>(),
+    "encode_fixed_key requires fixed-size members; use encode_key instead.");
+  std::array<unsigned char, fixed_key_size<T, Members...>()> key;
+  unsigned char* out = key.data();
+  ((key_encoding<std::decay_t<decltype(record.*Members)>>::encode(record.*Members, out),
+    out += key_encoding<std::decay_t<decltype(record.*Members)>>::size), ...);
+  return key;
+}
+
+// Variable-length key for any mix of supported member types
+template<auto ...Members, typename T>
+void encode_key(const T& record, std::string& out) {
+  auto append = [&out](const auto& value) {
+    using encoding = key_encoding<std::decay_t<decltype(value)>>;
+    if constexpr (encoding::fixed_size) {
+      unsigned char buffer[encoding::size];
+      encoding::encode(value, buffer);
+      out.append(reinterpret_cast<const char*>(buffer), encoding::size);
+    } else {
+      encoding::encode(value, out);
+    }
+  };
+  (append(record.*Members), ...);
+}
+
+// Below this many records a comparison sort beats the radix passes
+static constexpr std::size_t comparison_sort_threshold = 256;
+
+namespace detail {
+
+// One counting-sort pass per key byte, least significant first. Histograms for
+// every byte are built in a single read of the keys, and passes where every
+// key has the same byte are skipped.
+template<std::size_t K>
+void lsd_sort(std::vector<std::pair<std::array<unsigned char, K>, std::uint32_t>>& entries) {
+  using entry_t = std::pair<std::array<unsigned char, K>, std::uint32_t>;
+  std::vector<std::array<std::size_t, 256>> histograms(K);
+  for (auto& histogram : histograms) {
+    histogram.fill(0);
+  }
+  for (const auto& entry : entries) {
+    for (std::size_t b = 0; b < K; ++b) {
+      ++histograms[b][entry.first[b]];
+    }
+  }
+
+  std::vector<entry_t> scratch(entries.size());
+  for (std::size_t pass = 0; pass < K; ++pass) {
+    const std::size_t b = K - 1 - pass;
+    auto& histogram = histograms[b];
+    if (std::find(histogram.begin(), histogram.end(), entries.size()) != histogram.end()) {
+      continue;
+    }
+    std::size_t offset = 0;
+    for (auto& count : histogram) {
+      auto n = count;
+      count = offset;
+      offset += n;
+    }
+    for (auto& entry : entries) {
+      scratch[histogram[entry.first[b]]++] = std::move(entry);
+    }
+    entries.swap(scratch);
+  }
+}
+
+using variable_entry = std::pair<std::string, std::uint32_t>;
+
+// Most significant byte first, recursing into each bucket. Bucket 0 holds
+// keys that end at this depth.
+inline void msd_sort(variable_entry* begin, variable_entry* end, std::size_t depth,
+    std::vector<variable_entry>& scratch) {
+  const std::size_t n = end - begin;
+  if (n < comparison_sort_threshold) {
+    std::stable_sort(begin, end, [depth](const auto& a, const auto& b) {
+      return std::string_view(a.first).substr(std::min(depth, a.first.size())) <
+        std::string_view(b.first).substr(std::min(depth, b.first.size()));
+    });
+    return;
+  }
+
+  auto bucket_of = [depth](const variable_entry& entry) -> std::size_t {
+    return depth < entry.first.size() ?
+      static_cast<unsigned char>(entry.first[depth]) + 1 : 0;
+  };
+
+  std::array<std::size_t, 258> offsets = {};
+  for (auto it = begin; it != end; ++it) {
+    ++offsets[bucket_of(*it) + 1];
+  }
+  for (std::size_t i = 1; i < offsets.size(); ++i) {
+    offsets[i] += offsets[i - 1];
+  }
+
+  scratch.resize(std::max(scratch.size(), n));
+  auto next = offsets;
+  for (auto it = begin; it != end; ++it) {
+    scratch[next[bucket_of(*it)]++] = std::move(*it);
+  }
+  std::move(scratch.begin(), scratch.begin() + n, begin);
+
+  for (std::size_t bucket = 1; bucket < 257; ++bucket) {
+    if (offsets[bucket + 1] - offsets[bucket] > 1) {
+      msd_sort(begin + offsets[bucket], begin + offsets[bucket + 1], depth + 1, scratch);
+    }
+  }
+}
+
+template<typename T, typename Entry>
+void apply_permutation(std::vector<T>& records, const std::vector<Entry>& entries) {
+  std::vector<T> sorted;
+  sorted.reserve(records.size());
+  for (const auto& entry : entries) {
+    sorted.push_back(std::move(records[entry.second]));
+  }
+  records.swap(sorted);
+}
+
+}  // namespace detail
+
+// Stable sort by the chosen members, equivalent to
+// std::stable_sort(records.begin(), records.end(), reflcompare::less_by<Members...>{})
+// but with one key extraction per record and no comparisons. Keys made only of
+// integral, enum and floating point members use LSD passes over fixed-width
+// keys; keys containing strings use MSD passes. The equivalence only holds
+// while no key member is NaN: less_by isn't a strict weak order then, and
+// the radix passes place NaNs as key_encoding describes.
+template<auto ...Members, typename T>
+void radix_sort(std::vector<T>& records) {
+  if (records.size() < comparison_sort_threshold) {
+    std::stable_sort(records.begin(), records.end(), reflcompare::less_by<Members...>{});
+    return;
+  }
+
+  if constexpr (is_fixed_size_key<T, Members...>()) {
+    constexpr auto K = fixed_key_size<T, Members...>();
+    std::vector<std::pair<std::array<unsigned char, K>, std::uint32_t>> entries;
+    entries.reserve(records.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+      entries.emplace_back(encode_fixed_key<Members...>(records[i]), static_cast<std::uint32_t>(i));
+    }
+    detail::lsd_sort(entries);
+    detail::apply_permutation(records, entries);
+  } else {
+    std::vector<detail::variable_entry> entries(records.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+      encode_key<Members...>(records[i], entries[i].first);
+      entries[i].second = static_cast<std::uint32_t>(i);
+    }
+    std::vector<detail::variable_entry> scratch;
+    detail::msd_sort(entries.data(), entries.data() + entries.size(), 0, scratch);
+    detail::apply_permutation(records, entries);
+  }
+}
+
+}  // namespace reflsort
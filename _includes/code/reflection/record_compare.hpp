@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "byte_utilities.hpp"
+#include "bytewise_compare.hpp"
+#include "compare_plan.hpp"
+#include "hot_cold.hpp"
+#include "instrumentation.hpp"
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+#include "soa_vector.hpp"
+
+namespace reflcompare {
+
+namespace refl = jk::refl_utilities;
+namespace plan = jk::compare_plan;
+namespace bytes = jk::byte_utilities;
+
+// Member by member through member_list, which the backend's
+// refl_utilities.hpp specializes, in the order compare_plan picks
+template<typename T>
+bool equal(const T& a, const T& b);
+
+template<typename T, std::size_t I>
+using member_type_t = typename refl::member_info_t<T, I>::type;
+
+template<typename T>
+constexpr std::size_t comparison_cost();
+
+template<typename T, std::size_t ...I>
+constexpr std::size_t member_costs(std::index_sequence<I...>) {
+  return (comparison_cost<member_type_t<T, I>>() + ... + 0);
+}
+
+// Rough cost of equal<T>: bytes touched for fixed-size types, dynamic_cost for
+// anything behind a pointer, the sum of the members for records.
+template<typename T>
+constexpr std::size_t comparison_cost() {
+  if constexpr (std::is_scalar<T>{} || is_bytewise_comparable<T>()) {
+    return sizeof(T);
+  } else if constexpr (is_bytewise_comparable_range<T>() &&
+                       metap::is_detected<metap::has_tuple_size, T>{}) {
+    return sizeof(T);
+  } else if constexpr (metap::is_detected<metap::iterable, T>{}) {
+    return plan::dynamic_cost;
+  } else if constexpr (refl::is_record<T>{} &&
+                       !metap::is_detected<metap::equality_comparable, T>{}) {
+    return member_costs<T>(std::make_index_sequence<refl::n_members<T>>{});
+  } else {
+    return sizeof(T);
+  }
+}
+
+template<typename T, std::size_t ...I>
+constexpr auto member_costs_array(std::index_sequence<I...>) {
+  return std::array<std::size_t, sizeof...(I)>{{comparison_cost<member_type_t<T, I>>()...}};
+}
+
+template<typename T, std::size_t ...I>
+constexpr auto member_names_array(std::index_sequence<I...>) {
+  return std::array<std::string_view, sizeof...(I)>{{
+    std::get<I>(refl::member_list<T>::value).name...}};
+}
+
+// The order in which equal visits the members of T, fixed at compile time
+template<typename T>
+struct compare_plan {
+  static constexpr std::size_t size = refl::n_members<T>;
+  static constexpr auto costs = member_costs_array<T>(std::make_index_sequence<size>{});
+  static constexpr auto names = member_names_array<T>(std::make_index_sequence<size>{});
+
+  static_assert(plan::hint_is_valid(names, compare_hint<T>::members),
+    "compare_hint names a member that the type doesn't have.");
+  static constexpr auto order = plan::make_order(costs, names, compare_hint<T>::members);
+};
+
+template<typename T, std::size_t I>
+bool member_equal(const T& a, const T& b) {
+  constexpr auto p = refl::member_info_t<T, I>::pointer;
+  return equal(a.*p, b.*p);
+}
+
+template<typename T, std::size_t ...I>
+bool members_equal(const T& a, const T& b, std::index_sequence<I...>) {
+  return (member_equal<T, compare_plan<T>::order[I]>(a, b) && ...);
+}
+
+// Column by column, so each bytewise column is one bytes::equal. Elements of
+// the other columns go through element_equal.
+template<typename M, typename F>
+bool column_equal(refl::column_span<const M> a, refl::column_span<const M> b, F& element_equal) {
+  if constexpr (is_bytewise_comparable<M>()) {
+    return bytes::equal(a.data(), b.data(), a.size() * sizeof(M));
+  } else {
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (!element_equal(a[i], b[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+template<typename T, typename F, std::size_t ...I>
+bool soa_columns_equal(const T& a, const T& b, F&& element_equal, std::index_sequence<I...>) {
+  return (column_equal(a.template column_at<I>(), b.template column_at<I>(), element_equal) && ...);
+}
+
+template<typename T>
+bool equal(const T& a, const T& b) {
+  REFLSTATS_SCOPE(T, equal, 0);
+  if constexpr (std::is_class<T>{} && is_bytewise_comparable<T>()) {
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+  } else if constexpr (is_bytewise_comparable_range<T>()) {
+    return a.size() == b.size() && bytes::equal(a.data(), b.data(),
+        a.size() * sizeof(contiguous_element_t<T>));
+  } else if constexpr (refl::is_soa_vector<T>{}) {
+    return a.size() == b.size() &&
+      soa_columns_equal(a, b, [](const auto& x, const auto& y) { return equal(x, y); },
+        std::make_index_sequence<T::n_columns>{});
+  } else if constexpr (refl::is_hot_cold<T>{}) {
+    return a.equal_members(b, [](const auto& x, const auto& y) { return equal(x, y); });
+  } else if constexpr (metap::is_detected<metap::equality_comparable, T>{}) {
+    return a == b;
+  } else {
+    static_assert(refl::is_record<T>{},
+      "Type contained a member which has no comparison operator defined.");
+    return members_equal(a, b, std::make_index_sequence<compare_plan<T>::size>{});
+  }
+}
+
+// Compares in plan order like equal, and counts which member was the first
+// to differ. suggested_hint() is a starting point for a compare_hint.
+template<typename T>
+class compare_profile {
+  using plan_t = compare_plan<T>;
+
+public:
+  bool equal(const T& a, const T& b) {
+    const auto index = first_mismatch(a, b, std::make_index_sequence<plan_t::size>{});
+    if (index == plan_t::size) {
+      return true;
+    }
+    mismatches_[index].fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Names of members that ever differed first, most frequent first
+  std::vector<std::string_view> suggested_hint() const {
+    std::array<std::size_t, plan_t::size> indices;
+    std::iota(indices.begin(), indices.end(), 0);
+    std::stable_sort(indices.begin(), indices.end(),
+      [this](std::size_t x, std::size_t y) {
+        return mismatches_[x].load(std::memory_order_relaxed) >
+          mismatches_[y].load(std::memory_order_relaxed);
+      });
+
+    std::vector<std::string_view> result;
+    for (auto index : indices) {
+      if (mismatches_[index].load(std::memory_order_relaxed) > 0) {
+        result.push_back(plan_t::names[index]);
+      }
+    }
+    return result;
+  }
+
+private:
+  template<std::size_t ...I>
+  static std::size_t first_mismatch(const T& a, const T& b, std::index_sequence<I...>) {
+    std::size_t mismatch = plan_t::size;
+    static_cast<void>(((member_equal<T, plan_t::order[I]>(a, b) ||
+      (mismatch = plan_t::order[I], false)) && ...));
+    return mismatch;
+  }
+
+  std::array<std::atomic<std::size_t>, plan_t::size> mismatches_ = {};
+};
+
+}  // namespace reflcompare
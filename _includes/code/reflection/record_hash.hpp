@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "byte_utilities.hpp"
+#include "bytewise_compare.hpp"
+#include "hot_cold.hpp"
+#include "member_list.hpp"
+#include "meta_utilities.hpp"
+
+namespace reflhash {
+
+namespace refl = jk::refl_utilities;
+namespace metap = jk::metaprogramming;
+namespace bytes = jk::byte_utilities;
+
+template<typename T>
+using std_hashable = decltype(std::hash<T>{}(std::declval<const T&>()));
+
+// Adjacent bytewise-comparable members are hashed with one call
+struct byte_run {
+  const unsigned char* begin = nullptr;
+  const unsigned char* end = nullptr;
+
+  void append(const void* data, std::size_t size, std::uint64_t& state) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    if (p != end) {
+      flush(state);
+      begin = p;
+    }
+    end = p + size;
+  }
+
+  void flush(std::uint64_t& state) {
+    if (begin != end) {
+      state = bytes::hash_combine(state, bytes::hash(begin, end - begin));
+    }
+    begin = end = nullptr;
+  }
+};
+
+template<typename T>
+void hash_append(std::uint64_t& state, const T& value);
+
+// Member by member in declaration order. A cold part that was never
+// allocated reads as the defaults, as it does for reflcompare::equal.
+template<typename T, std::size_t ...I>
+void hash_hot_cold(std::uint64_t& state, const T& value, std::index_sequence<I...>) {
+  static_cast<void>((hash_append(state, value.template get_at<I>()), ...));
+}
+
+// Mirrors the branches of reflcompare::equal, so that values it considers
+// equal always hash the same.
+template<typename T>
+void hash_append(std::uint64_t& state, const T& value) {
+  if constexpr (reflcompare::is_bytewise_comparable<T>()) {
+    state = bytes::hash_combine(state, bytes::hash(&value, sizeof(T)));
+  } else if constexpr (reflcompare::is_bytewise_comparable_range<T>()) {
+    state = bytes::hash_combine(state, value.size());
+    state = bytes::hash_combine(state, bytes::hash(value.data(),
+        value.size() * sizeof(reflcompare::contiguous_element_t<T>)));
+  } else if constexpr (refl::is_hot_cold<T>{}) {
+    hash_hot_cold(state, value, std::make_index_sequence<T::n_members>{});
+  } else if constexpr (metap::is_detected<metap::equality_comparable, T>{} &&
+                       metap::is_detected<std_hashable, T>{}) {
+    state = bytes::hash_combine(state, std::hash<T>{}(value));
+  } else if constexpr (metap::is_detected<metap::iterable, T>{}) {
+    state = bytes::hash_combine(state, value.size());
+    for (const auto& entry : value) {
+      hash_append(state, entry);
+    }
+  } else {
+    static_assert(refl::is_record<T>{} &&
+        !metap::is_detected<metap::equality_comparable, T>{},
+      "Type has an equality operator but no std::hash specialization.");
+
+    byte_run run;
+    refl::for_each_member<T>([&value, &state, &run](const auto& member_info) {
+      const auto& member = value.*member_info.pointer;
+      using MemberT = std::decay_t<decltype(member)>;
+      if constexpr (reflcompare::is_bytewise_comparable<MemberT>()) {
+        run.append(&member, sizeof(MemberT), state);
+      } else {
+        run.flush(state);
+        hash_append(state, member);
+      }
+    });
+    run.flush(state);
+  }
+}
+
+template<typename T>
+std::size_t hash(const T& value) {
+  std::uint64_t state = 0;
+  hash_append(state, value);
+  return static_cast<std::size_t>(state);
+}
+
+// unordered_set<T, reflhash::hasher<T>, reflhash::equal_to<T>>
+template<typename T>
+struct hasher {
+  std::size_t operator()(const T& value) const {
+    return hash(value);
+  }
+};
+
+template<typename T>
+struct equal_to {
+  bool operator()(const T& a, const T& b) const {
+    return reflcompare::equal(a, b);
+  }
+};
+
+}  // namespace reflhash
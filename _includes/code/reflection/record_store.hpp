@@ -0,0 +1,312 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "byte_utilities.hpp"
+#include "mapped_file.hpp"
+#include "member_layout.hpp"
+#include "soa_vector.hpp"
+
+namespace reflstore {
+
+namespace bytes = jk::byte_utilities;
+namespace refl = jk::refl_utilities;
+
+// Changes whenever a member of T is added, removed, renamed, retyped or moved
+template<typename T>
+std::uint64_t schema_fingerprint() {
+  static const std::uint64_t fingerprint = [] {
+    std::string description = std::to_string(sizeof(T)) + " " + std::to_string(alignof(T));
+    for (const auto& member : refl::member_layouts<T>()) {
+      description += "\n";
+      description += member.name;
+      description += " ";
+      description += member.type;
+      description += " " + std::to_string(member.offset) + " " + std::to_string(member.size);
+    }
+    return bytes::hash(description.data(), description.size());
+  }();
+  return fingerprint;
+}
+
+static constexpr char store_magic[8] = {'R', 'E', 'F', 'L', 'S', 'T', 'O', 'R'};
+static constexpr std::uint32_t store_version = 1;
+// Records start here, so they're aligned in the page-aligned mapping
+static constexpr std::size_t header_size = 64;
+
+struct store_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t fingerprint;
+  // Records that were completely written and synced. Anything after them is
+  // left over from an interrupted append.
+  std::uint64_t count;
+};
+
+static_assert(sizeof(store_header) <= header_size, "Header doesn't fit.");
+
+enum struct store_result {
+  success,
+  open_failed,
+  not_a_store,
+  schema_mismatch,
+  read_only,
+  io_error
+};
+
+inline std::string store_result_message(store_result result) {
+  switch (result) {
+    case store_result::success:
+      return "Success";
+    case store_result::open_failed:
+      return "Could not open the store file";
+    case store_result::not_a_store:
+      return "File is not a record store or is truncated";
+    case store_result::schema_mismatch:
+      return "Store was written with a different layout of the record type";
+    case store_result::read_only:
+      return "Store was opened read-only";
+    case store_result::io_error:
+      return "Could not write to the store file";
+  }
+  return "";
+}
+
+enum struct open_mode {
+  read_only,
+  read_write
+};
+
+namespace detail {
+
+inline bool write_all(int fd, const void* data, std::size_t n, off_t offset) {
+  const auto* p = static_cast<const unsigned char*>(data);
+  while (n > 0) {
+    const ssize_t written = ::pwrite(fd, p, n, offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    p += written;
+    n -= static_cast<std::size_t>(written);
+    offset += written;
+  }
+  return true;
+}
+
+inline bool read_all(int fd, void* data, std::size_t n, off_t offset) {
+  auto* p = static_cast<unsigned char*>(data);
+  while (n > 0) {
+    const ssize_t read = ::pread(fd, p, n, offset);
+    if (read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read <= 0) {
+      return false;
+    }
+    p += read;
+    n -= static_cast<std::size_t>(read);
+    offset += read;
+  }
+  return true;
+}
+
+}  // namespace detail
+
+// An append-only file of T in its native layout. Reopening maps the file
+// instead of parsing it, so reload time doesn't depend on the record count.
+//
+// reflstore::record_store<sample> store;
+// store.open("samples.store");
+// store.append(batch.data(), batch.size());
+// for (const sample& s : store.records()) ...
+//
+// An append writes and syncs the records before it syncs the new count in
+// the header, so a crash leaves either the old or the new count, and open()
+// discards any partially written records past it. One process may write a
+// store at a time.
+template<typename T>
+class record_store {
+  static_assert(std::is_trivially_copyable<T>{}, "Records are stored as raw bytes.");
+  static_assert(std::is_standard_layout<T>{},
+    "The schema fingerprint relies on member offsets that only standard-layout types fix.");
+  static_assert(alignof(T) <= header_size, "Records would be misaligned in the mapping.");
+
+public:
+  record_store() = default;
+
+  record_store(const record_store&) = delete;
+  record_store& operator=(const record_store&) = delete;
+
+  record_store(record_store&& other)
+  : fd_(std::exchange(other.fd_, -1)), mode_(other.mode_), count_(std::exchange(other.count_, 0)),
+    mapping_(std::move(other.mapping_)), mapped_count_(std::exchange(other.mapped_count_, 0)) {}
+
+  record_store& operator=(record_store&& other) {
+    if (this != &other) {
+      close();
+      fd_ = std::exchange(other.fd_, -1);
+      mode_ = other.mode_;
+      count_ = std::exchange(other.count_, 0);
+      mapping_ = std::move(other.mapping_);
+      mapped_count_ = std::exchange(other.mapped_count_, 0);
+    }
+    return *this;
+  }
+
+  ~record_store() {
+    close();
+  }
+
+  // Creates an empty store if path doesn't exist and mode is read_write
+  store_result open(const char* path, open_mode mode = open_mode::read_write) {
+    close();
+    const int flags = mode == open_mode::read_write ? O_RDWR | O_CREAT : O_RDONLY;
+    fd_ = ::open(path, flags | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      return store_result::open_failed;
+    }
+    mode_ = mode;
+
+    const auto result = load_header();
+    if (result != store_result::success) {
+      close();
+    }
+    return result;
+  }
+
+  void close() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+    fd_ = -1;
+    count_ = 0;
+    mapping_.close();
+    mapped_count_ = 0;
+  }
+
+  std::size_t size() const {
+    return count_;
+  }
+
+  store_result append(const T* records, std::size_t n) {
+    if (mode_ != open_mode::read_write) {
+      return store_result::read_only;
+    }
+    if (fd_ < 0) {
+      return store_result::io_error;
+    }
+    if (n == 0) {
+      return store_result::success;
+    }
+    const off_t end = static_cast<off_t>(header_size + count_ * sizeof(T));
+    if (!detail::write_all(fd_, records, n * sizeof(T), end) || ::fdatasync(fd_) != 0) {
+      // Not committed: the next open() drops whatever made it to the file
+      return store_result::io_error;
+    }
+    const std::uint64_t count = count_ + n;
+    if (!detail::write_all(fd_, &count, sizeof(count), offsetof(store_header, count)) ||
+        ::fdatasync(fd_) != 0) {
+      return store_result::io_error;
+    }
+    count_ = count;
+    return store_result::success;
+  }
+
+  store_result append(const T& record) {
+    return append(&record, 1);
+  }
+
+  template<typename Range>
+  store_result append(const Range& records) {
+    return append(std::data(records), std::size(records));
+  }
+
+  // The committed records, read straight from the mapped file. Valid until
+  // the next append or close.
+  refl::column_span<const T> records() {
+    if (count_ == 0) {
+      return {};
+    }
+    if (mapped_count_ != count_) {
+      if (!mapping_.map(fd_) ||
+          mapping_.view().size() < header_size + count_ * sizeof(T)) {
+        mapping_.close();
+        mapped_count_ = 0;
+        return {};
+      }
+      mapped_count_ = count_;
+    }
+    return {reinterpret_cast<const T*>(mapping_.view().data() + header_size), count_};
+  }
+
+private:
+  store_result load_header() {
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+      return store_result::open_failed;
+    }
+    const auto file_size = static_cast<std::size_t>(st.st_size);
+
+    if (file_size == 0 && mode_ == open_mode::read_write) {
+      store_header header = {};
+      std::memcpy(header.magic, store_magic, sizeof(store_magic));
+      header.version = store_version;
+      header.record_size = sizeof(T);
+      header.fingerprint = schema_fingerprint<T>();
+      header.count = 0;
+      unsigned char block[header_size] = {};
+      std::memcpy(block, &header, sizeof(header));
+      if (!detail::write_all(fd_, block, header_size, 0) || ::fdatasync(fd_) != 0) {
+        return store_result::io_error;
+      }
+      return store_result::success;
+    }
+
+    store_header header;
+    if (file_size < header_size || !detail::read_all(fd_, &header, sizeof(header), 0) ||
+        std::memcmp(header.magic, store_magic, sizeof(store_magic)) != 0 ||
+        header.version != store_version) {
+      return store_result::not_a_store;
+    }
+    if (header.record_size != sizeof(T) || header.fingerprint != schema_fingerprint<T>()) {
+      return store_result::schema_mismatch;
+    }
+
+    // Checked by division, since a corrupt count could overflow the size
+    if (header.count > (file_size - header_size) / sizeof(T)) {
+      return store_result::not_a_store;
+    }
+    const std::size_t committed_size = header_size + header.count * sizeof(T);
+    if (file_size > committed_size && mode_ == open_mode::read_write) {
+      // Left over from an append that didn't commit
+      if (::ftruncate(fd_, static_cast<off_t>(committed_size)) != 0 || ::fdatasync(fd_) != 0) {
+        return store_result::io_error;
+      }
+    }
+    count_ = header.count;
+    return store_result::success;
+  }
+
+  int fd_ = -1;
+  open_mode mode_ = open_mode::read_only;
+  std::size_t count_ = 0;
+  jk::mapped_file::mapped_file mapping_;
+  std::size_t mapped_count_ = 0;
+};
+
+}  // namespace reflstore
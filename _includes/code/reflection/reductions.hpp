@@ -0,0 +1,427 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "member_key.hpp"
+#include "parallel_utilities.hpp"
+#include "soa_vector.hpp"
+
+namespace reflreduce {
+
+namespace parallel = jk::parallel_utilities;
+namespace refl = jk::refl_utilities;
+
+struct reduce_options {
+  // Elements per task. Partial results are combined in chunk order, so the
+  // result of a floating point sum doesn't depend on the thread count.
+  std::size_t chunk_size = 1 << 16;
+  unsigned threads = parallel::default_threads();
+};
+
+// size values of type M, stride bytes apart
+template<typename M>
+struct strided_view {
+  const unsigned char* base;
+  std::size_t stride;
+  std::size_t size;
+
+  bool contiguous() const {
+    return stride == sizeof(M);
+  }
+  const M* data() const {
+    return reinterpret_cast<const M*>(base);
+  }
+  const M& operator[](std::size_t i) const {
+    return *reinterpret_cast<const M*>(base + i * stride);
+  }
+};
+
+template<typename Range>
+struct record_of {
+  using type = std::remove_cv_t<std::remove_reference_t<
+    decltype(*std::data(std::declval<const Range&>()))>>;
+};
+
+template<typename T>
+struct record_of<refl::soa_vector<T>> {
+  using type = T;
+};
+
+template<typename Range>
+using record_t = typename record_of<Range>::type;
+
+template<auto Member>
+using member_t = refl::member_type_t<Member>;
+
+// A soa_vector column is already contiguous
+template<auto Member, typename T>
+strided_view<member_t<Member>> member_view(const refl::soa_vector<T>& records) {
+  const auto column = records.template column<Member>();
+  return {reinterpret_cast<const unsigned char*>(column.data()),
+    sizeof(member_t<Member>), column.size()};
+}
+
+// Any contiguous range of records: the member is read with a stride of sizeof(T)
+template<auto Member, typename Range>
+strided_view<member_t<Member>> member_view(const Range& records) {
+  const std::size_t n = std::size(records);
+  if (n == 0) {
+    return {nullptr, sizeof(record_t<Range>), 0};
+  }
+  return {reinterpret_cast<const unsigned char*>(&(std::data(records)[0].*Member)),
+    sizeof(record_t<Range>), n};
+}
+
+namespace kernels {
+
+template<typename M>
+using sum_t = std::conditional_t<std::is_floating_point<M>{},
+  std::conditional_t<std::is_same<M, long double>{}, long double, double>,
+  std::conditional_t<std::is_signed<M>{}, std::int64_t, std::uint64_t>>;
+
+// Four accumulators, so consecutive adds don't wait on each other
+template<typename M>
+sum_t<M> sum(const M* p, std::size_t n) {
+  sum_t<M> acc[4] = {};
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc[0] += p[i];
+    acc[1] += p[i + 1];
+    acc[2] += p[i + 2];
+    acc[3] += p[i + 3];
+  }
+  for (; i < n; ++i) {
+    acc[0] += p[i];
+  }
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+template<typename M>
+void extrema(const M* p, std::size_t n, M& lo, M& hi) {
+  for (std::size_t i = 0; i < n; ++i) {
+    lo = p[i] < lo ? p[i] : lo;
+    hi = hi < p[i] ? p[i] : hi;
+  }
+}
+
+#if defined(__SSE2__)
+inline double sum(const double* p, std::size_t n) {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_loadu_pd(p + i));
+    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(p + i + 2));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+  double result = lanes[0] + lanes[1];
+  for (; i < n; ++i) {
+    result += p[i];
+  }
+  return result;
+}
+
+// Widened to double before adding, like the scalar version
+inline double sum(const float* p, std::size_t n) {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128 v = _mm_loadu_ps(p + i);
+    acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(v));
+    acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+  double result = lanes[0] + lanes[1];
+  for (; i < n; ++i) {
+    result += p[i];
+  }
+  return result;
+}
+
+// Widened to 64 bits by interleaving with the sign (or zero) bits
+template<typename M>
+sum_t<M> sum_int32(const M* p, std::size_t n) {
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    const __m128i high = std::is_signed<M>{} ? _mm_srai_epi32(v, 31) : _mm_setzero_si128();
+    acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, high));
+    acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, high));
+  }
+  sum_t<M> lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(acc0, acc1));
+  sum_t<M> result = lanes[0] + lanes[1];
+  for (; i < n; ++i) {
+    result += p[i];
+  }
+  return result;
+}
+
+inline std::int64_t sum(const std::int32_t* p, std::size_t n) {
+  return sum_int32(p, n);
+}
+
+inline std::uint64_t sum(const std::uint32_t* p, std::size_t n) {
+  return sum_int32(p, n);
+}
+
+// NaN elements are skipped: minpd returns its second operand if either is NaN
+inline void extrema(const double* p, std::size_t n, double& lo, double& hi) {
+  __m128d vlo = _mm_set1_pd(lo);
+  __m128d vhi = _mm_set1_pd(hi);
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m128d v = _mm_loadu_pd(p + i);
+    vlo = _mm_min_pd(v, vlo);
+    vhi = _mm_max_pd(v, vhi);
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, vlo);
+  lo = std::min(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, vhi);
+  hi = std::max(lanes[0], lanes[1]);
+  extrema<double>(p + i, n - i, lo, hi);
+}
+
+inline void extrema(const float* p, std::size_t n, float& lo, float& hi) {
+  __m128 vlo = _mm_set1_ps(lo);
+  __m128 vhi = _mm_set1_ps(hi);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128 v = _mm_loadu_ps(p + i);
+    vlo = _mm_min_ps(v, vlo);
+    vhi = _mm_max_ps(v, vhi);
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, vlo);
+  lo = std::min({lanes[0], lanes[1], lanes[2], lanes[3]});
+  _mm_storeu_ps(lanes, vhi);
+  hi = std::max({lanes[0], lanes[1], lanes[2], lanes[3]});
+  extrema<float>(p + i, n - i, lo, hi);
+}
+
+// SSE2 has no pminsd, so select with a comparison mask
+inline void extrema(const std::int32_t* p, std::size_t n, std::int32_t& lo, std::int32_t& hi) {
+  __m128i vlo = _mm_set1_epi32(lo);
+  __m128i vhi = _mm_set1_epi32(hi);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    const __m128i below = _mm_cmpgt_epi32(vlo, v);
+    const __m128i above = _mm_cmpgt_epi32(v, vhi);
+    vlo = _mm_or_si128(_mm_and_si128(below, v), _mm_andnot_si128(below, vlo));
+    vhi = _mm_or_si128(_mm_and_si128(above, v), _mm_andnot_si128(above, vhi));
+  }
+  std::int32_t lanes[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), vlo);
+  lo = std::min({lanes[0], lanes[1], lanes[2], lanes[3]});
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), vhi);
+  hi = std::max({lanes[0], lanes[1], lanes[2], lanes[3]});
+  extrema<std::int32_t>(p + i, n - i, lo, hi);
+}
+#endif
+
+}  // namespace kernels
+
+template<typename M>
+struct sum_accumulator {
+  kernels::sum_t<M> value = 0;
+
+  void add(const M* p, std::size_t n) {
+    value += kernels::sum(p, n);
+  }
+  void merge(const sum_accumulator& other) {
+    value += other.value;
+  }
+};
+
+template<typename M>
+struct extrema_accumulator {
+  static constexpr M initial_lo = std::numeric_limits<M>::has_infinity ?
+    std::numeric_limits<M>::infinity() : std::numeric_limits<M>::max();
+  static constexpr M initial_hi = std::numeric_limits<M>::has_infinity ?
+    -std::numeric_limits<M>::infinity() : std::numeric_limits<M>::lowest();
+
+  M lo = initial_lo;
+  M hi = initial_hi;
+
+  void add(const M* p, std::size_t n) {
+    kernels::extrema(p, n, lo, hi);
+  }
+  void merge(const extrema_accumulator& other) {
+    lo = other.lo < lo ? other.lo : lo;
+    hi = hi < other.hi ? other.hi : hi;
+  }
+};
+
+// Equal-width bins over [lower, upper)
+struct bin_counts {
+  double lower = 0;
+  double upper = 0;
+  std::vector<std::size_t> counts;
+  // Values below lower
+  std::size_t underflow = 0;
+  // Values at or above upper, and NaN
+  std::size_t overflow = 0;
+};
+
+template<typename M>
+struct histogram_accumulator {
+  bin_counts result;
+  double scale;
+
+  histogram_accumulator(double lower, double upper, std::size_t bins)
+  : result{lower, upper, std::vector<std::size_t>(bins)},
+    scale(static_cast<double>(bins) / (upper - lower)) {}
+
+  // Scalar: the scattered increments don't vectorize with SSE2
+  void add(const M* p, std::size_t n) {
+    const std::size_t last = result.counts.size() - 1;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double x = static_cast<double>(p[i]);
+      if (x < result.lower) {
+        ++result.underflow;
+      } else if (!(x < result.upper)) {
+        ++result.overflow;
+      } else {
+        // Rounding can put a value just below upper one past the last bin
+        ++result.counts[std::min(static_cast<std::size_t>((x - result.lower) * scale), last)];
+      }
+    }
+  }
+  void merge(const histogram_accumulator& other) {
+    for (std::size_t i = 0; i < result.counts.size(); ++i) {
+      result.counts[i] += other.result.counts[i];
+    }
+    result.underflow += other.result.underflow;
+    result.overflow += other.result.overflow;
+  }
+};
+
+// Feeds [begin, end) of the view to acc. Strided values are gathered into a
+// small contiguous block first, so every accumulator only needs a
+// contiguous kernel.
+template<typename M, typename Acc>
+void accumulate(const strided_view<M>& view, std::size_t begin, std::size_t end, Acc& acc) {
+  if (view.contiguous()) {
+    acc.add(view.data() + begin, end - begin);
+    return;
+  }
+  static constexpr std::size_t block = 256;
+  M buffer[block];
+  for (std::size_t i = begin; i < end; i += block) {
+    const std::size_t n = std::min(block, end - i);
+    for (std::size_t j = 0; j < n; ++j) {
+      buffer[j] = view[i + j];
+    }
+    acc.add(buffer, n);
+  }
+}
+
+// One accumulator per chunk, filled in parallel and merged in chunk order
+template<typename M, typename Acc>
+Acc reduce(const strided_view<M>& view, const Acc& init, const reduce_options& options) {
+  const std::size_t chunk = std::max<std::size_t>(options.chunk_size, 1);
+  std::vector<Acc> partials((view.size + chunk - 1) / chunk, init);
+  parallel::parallel_for(view.size, chunk, options.threads,
+    [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; i += chunk) {
+        accumulate(view, i, std::min(end, i + chunk), partials[i / chunk]);
+      }
+    });
+
+  Acc result = init;
+  for (const auto& partial : partials) {
+    result.merge(partial);
+  }
+  return result;
+}
+
+template<typename Range, auto Key>
+using key_member_t = member_t<refl::member_of<record_t<Range>, Key>()>;
+
+template<typename M>
+constexpr bool is_reducible() {
+  return std::is_arithmetic<M>{} && !std::is_same<M, bool>{};
+}
+
+// Sum of one member over all records, in a 64-bit integer or a double.
+//
+// reflreduce::sum<&record::latency>(records)
+// reflreduce::sum<latency_name>(records)  // static constexpr char latency_name[] = "latency";
+template<auto Key, typename Range>
+auto sum(const Range& records, const reduce_options& options = {}) {
+  constexpr auto member = refl::member_of<record_t<Range>, Key>();
+  using M = member_t<member>;
+  static_assert(is_reducible<M>(), "sum needs an arithmetic member.");
+  return reduce(member_view<member>(records), sum_accumulator<M>{}, options).value;
+}
+
+// Smallest and largest value of one member. NaN values are skipped, so it's
+// empty when there are no records or every value is NaN.
+template<auto Key, typename Range>
+std::optional<std::pair<key_member_t<Range, Key>, key_member_t<Range, Key>>> minmax(
+    const Range& records, const reduce_options& options = {}) {
+  constexpr auto member = refl::member_of<record_t<Range>, Key>();
+  using M = member_t<member>;
+  static_assert(is_reducible<M>(), "minmax needs an arithmetic member.");
+  const auto view = member_view<member>(records);
+  if (view.size == 0) {
+    return std::nullopt;
+  }
+  const auto result = reduce(view, extrema_accumulator<M>{}, options);
+  if (result.hi < result.lo) {
+    // Still the initial values
+    return std::nullopt;
+  }
+  return std::make_pair(result.lo, result.hi);
+}
+
+template<auto Key, typename Range>
+std::optional<key_member_t<Range, Key>> min(
+    const Range& records, const reduce_options& options = {}) {
+  if (auto result = minmax<Key>(records, options)) {
+    return result->first;
+  }
+  return std::nullopt;
+}
+
+template<auto Key, typename Range>
+std::optional<key_member_t<Range, Key>> max(
+    const Range& records, const reduce_options& options = {}) {
+  if (auto result = minmax<Key>(records, options)) {
+    return result->second;
+  }
+  return std::nullopt;
+}
+
+// Counts of one member in bins equal-width bins over [lower, upper). bins
+// must be positive and lower less than upper.
+template<auto Key, typename Range>
+bin_counts histogram(const Range& records, double lower, double upper, std::size_t bins,
+    const reduce_options& options = {}) {
+  constexpr auto member = refl::member_of<record_t<Range>, Key>();
+  using M = member_t<member>;
+  static_assert(is_reducible<M>(), "histogram needs an arithmetic member.");
+  return reduce(member_view<member>(records),
+    histogram_accumulator<M>(lower, upper, bins), options).result;
+}
+
+}  // namespace reflreduce
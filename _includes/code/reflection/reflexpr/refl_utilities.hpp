@@ -1,8 +1,16 @@
 #pragma once
+#include "../hot_cold.hpp"
+#include "../member_key.hpp"
+#include "../member_list.hpp"
+#include "../name_index.hpp"
+#include "../soa_vector.hpp"
 #include "../string_literal.hpp"
 #include <reflexpr>
 
+#include <array>
 #include <experimental/type_traits>
+#include <string_view>
+#include <tuple>
 #include <variant>
 
 namespace jk {
@@ -31,6 +39,19 @@ using member_pack_as_tuple = std::tuple<
 template<typename T>
 struct n_fields : meta::get_size<meta::get_data_members_m<reflexpr(T)>> {};
 
+template<typename ...MetaField>
+struct member_info_pack {
+  static constexpr auto value = std::make_tuple(
+    member_info<meta::get_pointer<MetaField>::value>{
+      meta::get_base_name_v<MetaField>,
+      meta::get_base_name_v<meta::get_type_m<MetaField>>
+    }...);
+};
+
+template<typename T>
+struct member_list<T, std::enable_if_t<meta::Record<reflexpr(T)>>>
+  : meta::unpack_sequence_t<meta::get_data_members_m<reflexpr(T)>, member_info_pack> {};
+
 // generic meta-object fold
 template<typename ...Object>
 struct runtime_fold_helper {
@@ -40,34 +61,32 @@ struct runtime_fold_helper {
   }
 };
 
-template<typename ...MetaField>
-struct has_member_pack {
-  template<typename StrT>
-  static constexpr bool apply(const StrT& name) {
-    return (sl::equal(name, meta::get_base_name_v<MetaField>) || ...);
-  }
+template<typename ...MetaObject>
+struct base_names {
+  static constexpr std::array<std::string_view, sizeof...(MetaObject)> value{{
+    meta::get_base_name_v<MetaObject>...
+  }};
 };
 
+// Shared by every lookup on T, so each table is built once per type
+template<typename T>
+inline constexpr auto member_index = make_name_index(
+  meta::unpack_sequence_t<meta::get_data_members_m<reflexpr(T)>, base_names>::value);
+
+template<typename T>
+inline constexpr auto member_type_index = make_name_index(
+  meta::unpack_sequence_t<meta::get_member_types_m<reflexpr(T)>, base_names>::value);
+
 template<typename T, typename StrT>
 constexpr bool has_member(const StrT& member_name) {
-  return meta::unpack_sequence_t<
-    meta::get_member_types_m<reflexpr(T)>, has_member_pack
-  >::apply(member_name);
-}
-
-template<typename T, auto Str, std::size_t ...I>
-static constexpr auto index_helper(std::index_sequence<I...>) {
-  return ((Str ==
-            meta::get_base_name_v<
-              meta::get_element_m<
-                meta::get_data_members_m<reflexpr(T)>, I>
-              > ? I : 0
-          ) + ...);
+  return member_type_index<T>.contains(member_name);
 }
 
 template<typename T, auto Str>
 static constexpr auto index_of_member() {
-  return index_helper<T, Str>(std::make_index_sequence<n_fields<T>{}>{});
+  constexpr auto index = member_index<T>.find(Str);
+  static_assert(index != member_index<T>.npos, "Type has no data member with this name.");
+  return index;
 }
 
 template<typename T, auto Str>
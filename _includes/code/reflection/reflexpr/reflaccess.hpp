@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "../member_access.hpp"
+#include "refl_utilities.hpp"
+#include "reflser.hpp"
+
+namespace reflaccess {
+
+namespace refl = jk::refl_utilities;
+
+template<typename T, std::size_t I>
+struct member_thunks {
+  static constexpr auto pointer = refl::member_info_t<T, I>::pointer;
+  using type = typename refl::member_info_t<T, I>::type;
+
+  static void* address(T& object) {
+    return &(object.*pointer);
+  }
+
+  // Appends the member's JSON to dst
+  static bool get(const T& object, std::string& dst) {
+    return reflser::serialize(object.*pointer, dst) == reflser::serialize_result::success;
+  }
+
+  // Decodes into a temporary so that a malformed value leaves the member as it was
+  static bool set(T& object, std::string_view src) {
+    type value;
+    if (reflser::deserialize(src, value) != reflser::deserialize_result::success) {
+      return false;
+    }
+    object.*pointer = std::move(value);
+    return true;
+  }
+};
+
+template<typename T, std::size_t ...I>
+constexpr auto member_descriptors(std::index_sequence<I...>) {
+  return std::array<member_descriptor<T>, sizeof...(I)>{{
+    member_descriptor<T>{
+      std::get<I>(refl::member_list<T>::value).name,
+      type_tag_of<typename member_thunks<T, I>::type>(),
+      &type_id<typename member_thunks<T, I>::type>,
+      &member_thunks<T, I>::address,
+      &member_thunks<T, I>::get,
+      &member_thunks<T, I>::set
+    }...
+  }};
+}
+
+template<typename T>
+constexpr auto make_descriptors() {
+  constexpr auto table = make_descriptor_table(
+    member_descriptors<T>(std::make_index_sequence<refl::n_members<T>>{}));
+  static_assert(table.index.valid, "Could not build a perfect hash over member names");
+  return table;
+}
+
+// Descriptors for the data members of T, indexed by name at compile time
+template<typename T>
+inline constexpr auto descriptors = make_descriptors<T>();
+
+template<typename M, typename T>
+M* member_if(T& object, std::string_view name) {
+  return member_if<M>(descriptors<T>, object, name);
+}
+
+template<typename T>
+access_result get_json(const T& object, std::string_view name, std::string& dst) {
+  return get_json(descriptors<T>, object, name, dst);
+}
+
+template<typename T>
+access_result set_json(T& object, std::string_view name, std::string_view src) {
+  return set_json(descriptors<T>, object, name, src);
+}
+
+}  // namespace reflaccess
@@ -0,0 +1,7 @@
+#pragma once
+
+// Scalars and strings are written by reflser.hpp's serialize, records are
+// walked through member_list, which refl_utilities.hpp specializes
+#include "reflser.hpp"
+#include "refl_utilities.hpp"
+#include "../chunked_serializer.hpp"
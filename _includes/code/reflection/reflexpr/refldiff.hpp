@@ -0,0 +1,7 @@
+#pragma once
+
+// Records are diffed member by member through member_list, which
+// refl_utilities.hpp specializes
+#include "../diff_engine.hpp"
+#include "comparisons.hpp"
+#include "refl_utilities.hpp"
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <type_traits>
+
+#include "../perfect_hash.hpp"
+
+#include <reflexpr>
+
+namespace reflenum {
+
+namespace meta = std::meta;
+namespace ph = jk::perfect_hash;
+
+// value - first in the unsigned counterpart of the underlying type, so it
+// wraps instead of overflowing
+template<typename E>
+constexpr std::size_t enum_offset(E value, E first) {
+  using underlying_t = std::underlying_type_t<E>;
+  using unsigned_t = std::make_unsigned_t<underlying_t>;
+  return static_cast<unsigned_t>(static_cast<unsigned_t>(static_cast<underlying_t>(value)) -
+    static_cast<unsigned_t>(static_cast<underlying_t>(first)));
+}
+
+// True if the values are consecutive, starting from the first one
+template<typename E, std::size_t N>
+constexpr bool is_dense(const std::array<E, N>& values) {
+  for (std::size_t i = 0; i < N; ++i) {
+    if (enum_offset(values[i], values[0]) != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename E>
+struct enum_table {
+  static_assert(std::is_enum<E>{}, "enum_table requires an enumeration type");
+
+  template<typename ...MetaEnumerators>
+  struct collect {
+    static constexpr std::size_t size = sizeof...(MetaEnumerators);
+    static constexpr std::array<std::string_view, size> names = {{
+      meta::get_base_name_v<MetaEnumerators>...
+    }};
+    static constexpr std::array<E, size> values = {{
+      meta::get_constant_v<MetaEnumerators>...
+    }};
+  };
+
+  using enumerators = meta::unpack_sequence_t<
+    meta::get_enumerators_m<reflexpr(E)>, collect>;
+  using underlying_t = std::underlying_type_t<E>;
+
+  static constexpr std::size_t size = enumerators::size;
+  static constexpr auto names = enumerators::names;
+  static constexpr auto values = enumerators::values;
+
+  // name -> index, resolved with a single probe
+  static constexpr auto lookup = ph::make_table(names);
+  static_assert(lookup.valid, "Could not build a perfect hash over enumerator names");
+
+  // If the enumerators are 0..N-1 offset by a constant, value -> name is an array index
+  static constexpr bool dense = is_dense(values);
+};
+
+// Returns an empty string_view if value does not name an enumerator
+template<typename E>
+constexpr std::string_view to_string(E value) {
+  using table = enum_table<E>;
+  if constexpr (table::size == 0) {
+    return std::string_view();
+  } else if constexpr (table::dense) {
+    const std::size_t offset = enum_offset(value, table::values[0]);
+    if (offset < table::size) {
+      return table::names[offset];
+    }
+    return std::string_view();
+  } else {
+    for (std::size_t i = 0; i < table::size; ++i) {
+      if (table::values[i] == value) {
+        return table::names[i];
+      }
+    }
+    return std::string_view();
+  }
+}
+
+template<typename E>
+constexpr bool from_string(std::string_view name, E& dst) {
+  using table = enum_table<E>;
+  const auto index = table::lookup.find(name);
+  if (index == table::size) {
+    return false;
+  }
+  dst = table::values[index];
+  return true;
+}
+
+}  // namespace reflenum
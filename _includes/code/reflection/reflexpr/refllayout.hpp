@@ -0,0 +1,5 @@
+#pragma once
+
+// Member layouts for the analysis come from refl_utilities.hpp
+#include "../layout_analysis.hpp"
+#include "refl_utilities.hpp"
@@ -4,34 +4,32 @@
 #include <boost/hana/filter.hpp>
 #include <boost/hana/fold.hpp>
 #include <boost/hana/for_each.hpp>
+#include <boost/hana/length.hpp>
 #include <boost/hana/map.hpp>
 #include <boost/hana/string.hpp>
 #include <boost/hana/tuple.hpp>
 
 #include <boost/lexical_cast.hpp>
 
-#include <experimental/optional>
+#include <cstring>
+#include <string_view>
+#include <tuple>
 
+// parse and the other entry points live in option_parser.hpp and find the
+// options through member_list. PrefixMap is the older hana map lookup, kept
+// for the compile-time comparison in benchmarks/options_compile_time.cpp.
 #include "refl_utilities.hpp"
+#include "refldiff.hpp"
+#include "reflser.hpp"
+#include "../option_parser.hpp"
+#include "macros.hpp"
 #include "meta_utilities.hpp"
 
-#include <vrm/pp/arg_count.hpp>
-#include <vrm/pp/cat.hpp>
-
-#include <boost/hana/length.hpp>
-
-#include <iostream>
-
 namespace reflopt {
-  static const size_t max_value_length = 128;
-
   namespace refl = jk::refl_utilities;
   namespace metap = jk::metaprogramming;
   namespace hana = boost::hana;
 
-  template<typename T>
-  using optional_t = std::experimental::optional<T>;
-
   // Compare a hana string to a const char*
   template<typename Str>
   bool runtime_string_compare(const Str&, const char* x) {
@@ -66,17 +64,11 @@ namespace reflopt {
     return meta::get_element_m<meta::get_data_members_m<MetaT>, index>{};
   }
 
-  template<typename Id, typename Flag, typename ShortFlag, typename Help>
-  struct Option
-  {
-    static constexpr Id identifier;
-    static constexpr Flag flag;
-    static constexpr ShortFlag short_flag;
-    static constexpr Help help;
-  };
-
+  // Flag lookup through a compile-time hana map, one insertion per flag.
+  // Straightforward, but instantiation cost grows quickly with the number of
+  // options; parse goes through the flat arrays of OptionsMap instead.
   template<typename OptionsStruct>
-  struct OptionsMap {
+  struct PrefixMap {
     static constexpr auto collect_flags = [](auto&& x, auto&& field) {
       using T = UNWRAP_TYPE(field);
       auto result = hana::insert(
@@ -93,27 +85,28 @@ namespace reflopt {
 
     using MetaOptions = reflexpr(OptionsStruct);
     template<typename... MetaFields>
-    struct make_prefix_map {
+    struct filter_options {
       static constexpr auto helper() {
-        auto filtered = hana::filter(
+        return hana::filter(
           hana::make_tuple(hana::type_c<refl::unreflect_type<MetaFields>>...),
           [](auto&& field) {
             return hana::bool_c<
               metap::is_specialization<std::decay_t<UNWRAP_TYPE(field)>, Option>{}>;
           }
         );
-        static_assert(!hana::length(filtered) == hana::size_c<0>,
-            "No options found. Did you define options with the REFLOPT_OPTION macro?");
-        return hana::fold(
-          filtered,
-          hana::make_map(),
-          collect_flags
-        );
       }
     };
 
-    static constexpr auto prefix_map = meta::unpack_sequence_t<
-      meta::get_data_members_m<MetaOptions>, make_prefix_map>::helper();
+    static constexpr auto filtered = meta::unpack_sequence_t<
+      meta::get_data_members_m<MetaOptions>, filter_options>::helper();
+    static_assert(!hana::length(filtered) == hana::size_c<0>,
+        "No options found. Did you define options with the REFLOPT_OPTION macro?");
+
+    static constexpr auto prefix_map = hana::fold(
+      filtered,
+      hana::make_map(),
+      collect_flags
+    );
 
     static_assert(!hana::length(hana::keys(prefix_map)) == hana::size_c<0>);
 
@@ -135,64 +128,11 @@ namespace reflopt {
             constexpr auto member_pointer = meta::get_pointer<MetaInfo>::value;
             using MemberType = meta::get_reflected_type_t<meta::get_type_m<MetaInfo>>;
             options.*member_pointer = boost::lexical_cast<MemberType>(
-              value, strnlen(value, max_value_length));
+              value, strlen(value));
           }
         }
       );
     }
   };
 
-  // ArgVT boilerplate is to enable both char** and const char*[]'s for testing
-  template<typename OptionsStruct, typename ArgVT,
-    typename std::enable_if_t<
-      std::is_same<ArgVT, char**>{} || std::is_same<ArgVT, const char**>{}>* = nullptr
-  >
-  optional_t<OptionsStruct> parse(int argc, ArgVT const argv) {
-    OptionsStruct options;
-    for (int i = 1; i < argc; i += 2) {
-      if (OptionsMap<OptionsStruct>::contains(argv[i])) {
-          OptionsMap<OptionsStruct>::set(options, argv[i], argv[i + 1]);
-      } else {
-        // unknown prefix found
-        return std::experimental::nullopt;
-      }
-    }
-
-    return options;
-  }
-
-template<size_t N>
-struct hana_string_from_literal {
-  static constexpr auto apply(const char (&literal)[N]) {
-    return apply_helper(literal, std::make_index_sequence<N>{});
-  }
-
-  template<size_t ...I>
-  static constexpr auto apply_helper(const char (&literal)[N], std::index_sequence<I...>&&) {
-    return hana::string_c<literal[I]...>;
-  }
-};
-
 }  // namespace reflopt
-
-
-#define BOOST_HANA_STRING_T(Literal) \
-  decltype(Literal ## _s)
-
-#define REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, Help) \
-  reflopt::Option<BOOST_HANA_STRING_T(#Identifier), BOOST_HANA_STRING_T(Flag), \
-      BOOST_HANA_STRING_T(ShortFlag), BOOST_HANA_STRING_T(Help)> \
-    reflopt_ ## Identifier ## _tag; \
-  Type Identifier
-
-#define REFLOPT_OPTION_3(Type, Identifier, Flag) \
-  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, "", "")
-
-#define REFLOPT_OPTION_4(Type, Identifier, Flag, ShortFlag) \
-  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, "")
-
-#define REFLOPT_OPTION_5(Type, Identifier, Flag, ShortFlag, Help) \
-  REFLOPT_OPTION_HELPER(Type, Identifier, Flag, ShortFlag, Help)
-
-#define REFLOPT_OPTION(...) \
-  VRM_PP_CAT(REFLOPT_OPTION_, VRM_PP_ARGCOUNT(__VA_ARGS__))(__VA_ARGS__) \
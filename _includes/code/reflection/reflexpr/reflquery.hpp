@@ -0,0 +1,7 @@
+#pragma once
+
+// Member names in reflquery are resolved by refl_utilities.hpp, and result
+// rows serialize with reflser.
+#include "../query_engine.hpp"
+#include "refl_utilities.hpp"
+#include "reflser.hpp"
@@ -0,0 +1,5 @@
+#pragma once
+
+// Member names in reflreduce are resolved by refl_utilities.hpp
+#include "../reductions.hpp"
+#include "refl_utilities.hpp"
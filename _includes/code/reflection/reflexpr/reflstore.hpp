@@ -0,0 +1,5 @@
+#pragma once
+
+// Record layouts for the schema fingerprint come from refl_utilities.hpp
+#include "../record_store.hpp"
+#include "refl_utilities.hpp"
@@ -0,0 +1,542 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace jk {
+namespace refl_utilities {
+
+// Pointers to the data members of T in declaration order, as a std::tuple in
+// `value`. Defined in member_list.hpp.
+template<typename T>
+struct member_pointers;
+
+template<typename P>
+struct member_pointer_traits;
+
+template<typename C, typename M>
+struct member_pointer_traits<M C::*> {
+  using class_type = C;
+  using member_type = M;
+};
+
+// Columns start on a cache line, which is also enough for any SIMD load
+static constexpr std::size_t column_alignment = 64;
+
+template<typename M>
+class column_span {
+public:
+  column_span() = default;
+  column_span(M* data, std::size_t size) : data_(data), size_(size) {}
+
+  M* data() const {
+    return data_;
+  }
+  std::size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+  M* begin() const {
+    return data_;
+  }
+  M* end() const {
+    return data_ + size_;
+  }
+  M& operator[](std::size_t i) const {
+    return data_[i];
+  }
+
+private:
+  M* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+// Aligned, contiguous storage for one member. Unlike std::vector, bool
+// columns hold real bools, so every element has an address.
+template<typename M>
+class soa_column {
+public:
+  soa_column() = default;
+
+  soa_column(const soa_column& other) {
+    reserve(other.size_);
+    std::uninitialized_copy(other.data_, other.data_ + other.size_, data_);
+    size_ = other.size_;
+  }
+
+  soa_column(soa_column&& other)
+  : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+    capacity_(std::exchange(other.capacity_, 0)) {}
+
+  soa_column& operator=(soa_column other) {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    return *this;
+  }
+
+  ~soa_column() {
+    clear();
+    deallocate(data_);
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+  M* data() {
+    return data_;
+  }
+  const M* data() const {
+    return data_;
+  }
+  M& operator[](std::size_t i) {
+    return data_[i];
+  }
+  const M& operator[](std::size_t i) const {
+    return data_[i];
+  }
+
+  void reserve(std::size_t n) {
+    if (n <= capacity_) {
+      return;
+    }
+    M* data = allocate(n);
+    try {
+      std::uninitialized_move(data_, data_ + size_, data);
+    } catch (...) {
+      deallocate(data);
+      throw;
+    }
+    std::destroy(data_, data_ + size_);
+    deallocate(data_);
+    data_ = data;
+    capacity_ = n;
+  }
+
+  void resize(std::size_t n) {
+    if (n > capacity_) {
+      reserve(std::max(n, 2 * capacity_));
+    }
+    if (n > size_) {
+      std::uninitialized_value_construct(data_ + size_, data_ + n);
+    } else {
+      std::destroy(data_ + n, data_ + size_);
+    }
+    size_ = n;
+  }
+
+  // Like reserve, but doubles the capacity so that growing one element at a
+  // time stays amortized constant
+  void grow(std::size_t n) {
+    if (n > capacity_) {
+      reserve(std::max(n, capacity_ == 0 ? 16 : 2 * capacity_));
+    }
+  }
+
+  template<typename U>
+  void push_back(U&& value) {
+    grow(size_ + 1);
+    new (data_ + size_) M(std::forward<U>(value));
+    ++size_;
+  }
+
+  // Destroys the elements from n on
+  void truncate(std::size_t n) noexcept {
+    if (n < size_) {
+      std::destroy(data_ + n, data_ + size_);
+      size_ = n;
+    }
+  }
+
+  void clear() {
+    truncate(0);
+  }
+
+private:
+  static M* allocate(std::size_t n) {
+    return static_cast<M*>(::operator new(n * sizeof(M),
+      std::align_val_t(std::max(column_alignment, alignof(M)))));
+  }
+
+  static void deallocate(M* data) {
+    if (data) {
+      ::operator delete(data, std::align_val_t(std::max(column_alignment, alignof(M))));
+    }
+  }
+
+  M* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t capacity_ = 0;
+};
+
+// A std::vector<T> replacement that stores each member of T in its own
+// column, so a loop over one or two members only touches those members.
+//
+// v.push_back(record);
+// v[i].get<&T::latency>() += 1;
+// for (auto latency : v.column<&T::latency>()) ...
+//
+// Elements are proxies: v[i] converts to T and assigns from T. Iterating a
+// const soa_vector yields T by value, so generic code written against
+// std::vector<T>, like reflser::serialize, reads it unchanged.
+template<typename T>
+class soa_vector {
+  static constexpr auto pointers = member_pointers<T>::value;
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  static constexpr std::size_t n_columns = std::tuple_size<std::decay_t<decltype(pointers)>>{};
+
+  template<std::size_t I>
+  using member_t = typename member_pointer_traits<
+    std::decay_t<decltype(std::get<I>(pointers))>>::member_type;
+
+private:
+  template<std::size_t ...I>
+  static auto make_columns(std::index_sequence<I...>) -> std::tuple<soa_column<member_t<I>>...>;
+  using columns_t = decltype(make_columns(std::make_index_sequence<n_columns>{}));
+
+  template<auto Member, std::size_t ...I>
+  static constexpr std::size_t index_of(std::index_sequence<I...>) {
+    std::size_t result = n_columns;
+    static_cast<void>(((result = matches<Member, I>() ? I : result), ...));
+    return result;
+  }
+
+  template<auto Member, std::size_t I>
+  static constexpr bool matches() {
+    if constexpr (std::is_same<std::remove_cv_t<decltype(Member)>,
+        std::decay_t<decltype(std::get<I>(pointers))>>{}) {
+      return Member == std::get<I>(pointers);
+    } else {
+      return false;
+    }
+  }
+
+public:
+  template<auto Member>
+  static constexpr std::size_t column_index() {
+    return index_of<Member>(std::make_index_sequence<n_columns>{});
+  }
+
+  template<typename Vector>
+  class basic_reference {
+  public:
+    basic_reference(Vector* v, std::size_t i) : v_(v), i_(i) {}
+    basic_reference(const basic_reference&) = default;
+
+    // v[i] = v[j] copies the element, like it would for std::vector<T>
+    const basic_reference& operator=(const basic_reference& other) const {
+      static_assert(!std::is_const<Vector>{}, "Cannot assign through a const_reference.");
+      v_->set(i_, static_cast<T>(other));
+      return *this;
+    }
+
+    template<auto Member>
+    auto& get() const {
+      return v_->template column<Member>()[i_];
+    }
+
+    operator T() const {
+      return v_->get(i_);
+    }
+
+    template<typename V = Vector, typename = std::enable_if_t<!std::is_const<V>{}>>
+    const basic_reference& operator=(const T& value) const {
+      v_->set(i_, value);
+      return *this;
+    }
+
+  private:
+    Vector* v_;
+    std::size_t i_;
+  };
+
+  using reference = basic_reference<soa_vector>;
+  using const_reference = basic_reference<const soa_vector>;
+
+  // Input iterators: elements are proxies or copies, so the iterators can't
+  // meet the forward iterator requirements. + and - are there for code that
+  // steps from begin() or end(), such as reflser's separator check.
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = soa_vector::reference;
+    using pointer = void;
+
+    iterator(soa_vector* v, std::size_t i) : v_(v), i_(i) {}
+
+    reference operator*() const {
+      return reference(v_, i_);
+    }
+    iterator& operator++() {
+      ++i_;
+      return *this;
+    }
+    iterator operator++(int) {
+      return iterator(v_, i_++);
+    }
+    iterator operator+(difference_type n) const {
+      return iterator(v_, i_ + n);
+    }
+    iterator operator-(difference_type n) const {
+      return iterator(v_, i_ - n);
+    }
+    difference_type operator-(const iterator& other) const {
+      return static_cast<difference_type>(i_) - static_cast<difference_type>(other.i_);
+    }
+    bool operator==(const iterator& other) const {
+      return i_ == other.i_;
+    }
+    bool operator!=(const iterator& other) const {
+      return i_ != other.i_;
+    }
+
+  private:
+    soa_vector* v_;
+    std::size_t i_;
+  };
+
+  class const_iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = T;
+    using pointer = void;
+
+    const_iterator(const soa_vector* v, std::size_t i) : v_(v), i_(i) {}
+
+    T operator*() const {
+      return v_->get(i_);
+    }
+    const_iterator& operator++() {
+      ++i_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      return const_iterator(v_, i_++);
+    }
+    const_iterator operator+(difference_type n) const {
+      return const_iterator(v_, i_ + n);
+    }
+    const_iterator operator-(difference_type n) const {
+      return const_iterator(v_, i_ - n);
+    }
+    difference_type operator-(const const_iterator& other) const {
+      return static_cast<difference_type>(i_) - static_cast<difference_type>(other.i_);
+    }
+    bool operator==(const const_iterator& other) const {
+      return i_ == other.i_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return i_ != other.i_;
+    }
+
+  private:
+    const soa_vector* v_;
+    std::size_t i_;
+  };
+
+  std::size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  template<std::size_t I>
+  column_span<member_t<I>> column_at() {
+    return {std::get<I>(columns_).data(), size_};
+  }
+  template<std::size_t I>
+  column_span<const member_t<I>> column_at() const {
+    return {std::get<I>(columns_).data(), size_};
+  }
+
+  template<auto Member>
+  auto column() {
+    constexpr auto index = column_index<Member>();
+    static_assert(index < n_columns, "Not a data member of T.");
+    return column_at<index>();
+  }
+  template<auto Member>
+  auto column() const {
+    constexpr auto index = column_index<Member>();
+    static_assert(index < n_columns, "Not a data member of T.");
+    return column_at<index>();
+  }
+
+  reference operator[](std::size_t i) {
+    return reference(this, i);
+  }
+  const_reference operator[](std::size_t i) const {
+    return const_reference(this, i);
+  }
+
+  iterator begin() {
+    return iterator(this, 0);
+  }
+  iterator end() {
+    return iterator(this, size_);
+  }
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+  const_iterator end() const {
+    return const_iterator(this, size_);
+  }
+
+  // Gathers element i back into a T
+  T get(std::size_t i) const {
+    T result;
+    for_each_column([this, i, &result](auto p, const auto& column) {
+      result.*p = column[i];
+    });
+    return result;
+  }
+
+  void set(std::size_t i, const T& value) {
+    for_each_column([i, &value](auto p, auto& column) {
+      column[i] = value.*p;
+    });
+  }
+
+  // If copying or moving a member throws, the columns that were already
+  // written are rolled back and the vector is left as it was
+  void push_back(const T& value) {
+    grow(size_ + 1);
+    try {
+      for_each_column([&value](auto p, auto& column) {
+        column.push_back(value.*p);
+      });
+    } catch (...) {
+      roll_back();
+      throw;
+    }
+    ++size_;
+  }
+
+  void push_back(T&& value) {
+    grow(size_ + 1);
+    try {
+      for_each_column([&value](auto p, auto& column) {
+        column.push_back(std::move(value.*p));
+      });
+    } catch (...) {
+      roll_back();
+      throw;
+    }
+    ++size_;
+  }
+
+  // Bulk push_back. Forward ranges are read once per column, filling one
+  // column at a time; single-pass ranges, such as this class's own iterators
+  // or std::istream_iterator, are pushed back one element at a time.
+  template<typename It>
+  void append(It first, It last) {
+    append(first, last, typename std::iterator_traits<It>::iterator_category{});
+  }
+
+  void reserve(std::size_t n) {
+    for_each_column([n](auto, auto& column) {
+      column.reserve(n);
+    });
+  }
+
+  void resize(std::size_t n) {
+    for_each_column([n](auto, auto& column) {
+      column.resize(n);
+    });
+    size_ = n;
+  }
+
+  void clear() {
+    for_each_column([](auto, auto& column) {
+      column.clear();
+    });
+    size_ = 0;
+  }
+
+private:
+  template<typename It>
+  void append(It first, It last, std::input_iterator_tag) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  template<typename It>
+  void append(It first, It last, std::forward_iterator_tag) {
+    static_assert(std::is_base_of<std::forward_iterator_tag,
+        typename std::iterator_traits<It>::iterator_category>{},
+      "Filling column by column reads the range more than once.");
+    const auto n = static_cast<std::size_t>(std::distance(first, last));
+    grow(size_ + n);
+    try {
+      for_each_column([first, last](auto p, auto& column) {
+        for (auto it = first; it != last; ++it) {
+          column.push_back((*it).*p);
+        }
+      });
+    } catch (...) {
+      roll_back();
+      throw;
+    }
+    size_ += n;
+  }
+
+  void grow(std::size_t n) {
+    for_each_column([n](auto, auto& column) {
+      column.grow(n);
+    });
+  }
+
+  // Drops what a failed push_back or append left past size_
+  void roll_back() noexcept {
+    for_each_column([this](auto, auto& column) {
+      column.truncate(size_);
+    });
+  }
+
+  template<typename F>
+  void for_each_column(F&& f) {
+    for_each_column_impl(f, std::make_index_sequence<n_columns>{});
+  }
+  template<typename F>
+  void for_each_column(F&& f) const {
+    for_each_column_impl(f, std::make_index_sequence<n_columns>{});
+  }
+
+  template<typename F, std::size_t ...I>
+  void for_each_column_impl(F& f, std::index_sequence<I...>) {
+    (f(std::get<I>(pointers), std::get<I>(columns_)), ...);
+  }
+  template<typename F, std::size_t ...I>
+  void for_each_column_impl(F& f, std::index_sequence<I...>) const {
+    (f(std::get<I>(pointers), std::get<I>(columns_)), ...);
+  }
+
+  columns_t columns_;
+  std::size_t size_ = 0;
+};
+
+template<typename T>
+struct is_soa_vector : std::false_type {};
+template<typename T>
+struct is_soa_vector<soa_vector<T>> : std::true_type {};
+
+}  // namespace refl_utilities
+}  // namespace jk